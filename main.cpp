@@ -4,9 +4,215 @@
 #include <vector>
 #include <stdexcept>
 #include <limits> // Required for numeric_limits
+#include <chrono> // For timing copy-on-write against deep copies
+#include <sstream> // For splitting /proc/self/numa_maps lines
+#include <algorithm> // For std::find
 
 #include "matrix.hpp"
 
+// CPUs listed in /sys/devices/system/node/node<node>/cpulist, e.g. "0-3,8-11"
+std::vector<int> node_cpus(int node) {
+    std::vector<int> cpus;
+    std::ifstream list("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+    std::string range;
+    while (std::getline(list, range, ',')) {
+        try {
+            std::size_t dash = range.find('-');
+            int first = std::stoi(range.substr(0, dash));
+            int last = dash == std::string::npos ? first : std::stoi(range.substr(dash + 1));
+            for (int cpu = first; cpu <= last; ++cpu) {
+                cpus.push_back(cpu);
+            }
+        } catch (const std::exception&) {
+            // Trailing newline or malformed entry
+        }
+    }
+    return cpus;
+}
+
+// Resident anonymous pages of this process per NUMA node, summed from the
+// N<node>=<pages> fields of /proc/self/numa_maps. Matrix rows live in
+// anonymous heap and mmap regions; file-backed mappings are left out.
+std::vector<unsigned long long> process_pages_per_node(bool& available) {
+    std::vector<unsigned long long> pages;
+    std::ifstream maps("/proc/self/numa_maps");
+    available = static_cast<bool>(maps);
+    std::string line;
+    while (std::getline(maps, line)) {
+        if (line.find(" anon=") == std::string::npos) {
+            continue;
+        }
+        std::istringstream fields(line);
+        std::string field;
+        while (fields >> field) {
+            std::size_t eq = field.find('=');
+            if (field.size() < 2 || field[0] != 'N' || eq == std::string::npos) {
+                continue;
+            }
+            try {
+                std::size_t node = std::stoul(field.substr(1, eq - 1));
+                if (node >= pages.size()) {
+                    pages.resize(node + 1);
+                }
+                pages[node] += std::stoull(field.substr(eq + 1));
+            } catch (const std::exception&) {
+                // Not a per-node count
+            }
+        }
+    }
+    return pages;
+}
+
+// Print where this process's anonymous pages reside. With pinned workers the
+// pages on nodes that host none of the workers' CPUs are the ones every
+// worker must reach remotely, so their share is the process's remote-page
+// ratio. It describes placement only; counting actual remote accesses needs
+// hardware performance counters.
+void report_numa_placement(std::size_t rows) {
+    bool available = false;
+    std::vector<unsigned long long> pages = process_pages_per_node(available);
+    unsigned long long total = 0;
+    for (unsigned long long count : pages) {
+        total += count;
+    }
+    if (!available || total == 0) {
+        std::cout << "\nProcess NUMA page placement: not available on this system" << std::endl;
+        return;
+    }
+
+    const MatrixConfig& config = matrix_config();
+    const bool pinned = config.pin_threads || config.numa == NumaPolicy::first_touch;
+    const unsigned workers = matrix_detail::worker_count(rows);
+    if (!pinned || workers <= 1) {
+        std::cout << "\nProcess anonymous pages per node (workers not pinned, so no local/remote split):";
+        for (std::size_t node = 0; node < pages.size(); ++node) {
+            if (pages[node] > 0) {
+                std::cout << " N" << node << "=" << pages[node];
+            }
+        }
+        std::cout << std::endl;
+        return;
+    }
+
+    // Nodes of the CPUs the workers are pinned to (same mapping as pin_current_thread)
+    const std::vector<int>& cpus = matrix_detail::allowed_cpus();
+    std::vector<bool> worker_node(pages.size(), false);
+    std::string worker_nodes;
+    for (int node : online_numa_nodes()) {
+        std::vector<int> local = node_cpus(node);
+        bool hosts_worker = false;
+        for (unsigned w = 0; w < workers && !cpus.empty(); ++w) {
+            int cpu = cpus[static_cast<std::size_t>(w) * cpus.size() / workers];
+            hosts_worker = hosts_worker || std::find(local.begin(), local.end(), cpu) != local.end();
+        }
+        if (hosts_worker) {
+            if (static_cast<std::size_t>(node) < worker_node.size()) {
+                worker_node[node] = true;
+            }
+            worker_nodes += (worker_nodes.empty() ? "N" : ", N") + std::to_string(node);
+        }
+    }
+    if (worker_nodes.empty()) {
+        std::cout << "\nProcess NUMA page placement: worker CPUs could not be mapped to nodes" << std::endl;
+        return;
+    }
+    unsigned long long remote = 0;
+    for (std::size_t node = 0; node < pages.size(); ++node) {
+        if (!worker_node[node]) {
+            remote += pages[node];
+        }
+    }
+    std::streamsize precision = std::cout.precision();
+    std::cout << "\nProcess pages off the pinned workers' nodes (" << worker_nodes << "; /proc/self/numa_maps): "
+              << std::setprecision(2) << 100.0 * static_cast<double>(remote) / static_cast<double>(total)
+              << "% (" << remote << " of " << total << " anonymous pages)" << std::endl;
+    std::cout.precision(precision);
+}
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--numa=none|first-touch|interleave] [--threads=N] [--pin] <input_filename>" << std::endl;
+}
+
+// Parse the option flags into matrix_config(); returns false on an invalid flag
+bool parse_options(int argc, char* argv[], std::string& filename) {
+    MatrixConfig& config = matrix_config();
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg.rfind("--numa=", 0) == 0) {
+            std::string policy = arg.substr(7);
+            if (policy == "none") {
+                config.numa = NumaPolicy::none;
+            } else if (policy == "first-touch") {
+                config.numa = NumaPolicy::first_touch;
+            } else if (policy == "interleave") {
+                config.numa = NumaPolicy::interleave;
+            } else {
+                std::cerr << "Error: Unknown NUMA policy \"" << policy << "\"." << std::endl;
+                return false;
+            }
+        } else if (arg.rfind("--threads=", 0) == 0) {
+            try {
+                int threads = std::stoi(arg.substr(10));
+                if (threads <= 0) {
+                    throw std::invalid_argument("non-positive");
+                }
+                config.threads = static_cast<unsigned>(threads);
+            } catch (const std::exception&) {
+                std::cerr << "Error: Thread count must be a positive integer." << std::endl;
+                return false;
+            }
+        } else if (arg == "--pin") {
+            config.pin_threads = true;
+        } else if (arg.rfind("--", 0) == 0) {
+            std::cerr << "Error: Unknown option \"" << arg << "\"." << std::endl;
+            return false;
+        } else if (filename.empty()) {
+            filename = arg;
+        } else {
+            std::cerr << "Error: Only one input file may be given." << std::endl;
+            return false;
+        }
+    }
+    if (filename.empty()) {
+        return false;
+    }
+    return true;
+}
+
+// Compare the memory and time of copy-on-write variants of a matrix against
+// the deep copies matrix_ops made before storage was shared
+template <typename T>
+void report_copy_on_write(const Matrix<T>& original, const std::vector<const Matrix<T>*>& variants, T new_value) {
+    std::vector<const Matrix<T>*> all = variants;
+    all.push_back(&original);
+    std::size_t shared_bytes = Matrix<T>::storage_bytes(all);
+    std::size_t deep_bytes = original.storage_bytes() * all.size();
+
+    // Rebuild the same variants both ways and time them
+    std::size_t N = original.get_size();
+    auto time_variants = [&](auto make_copy) {
+        auto start = std::chrono::steady_clock::now();
+        Matrix<T> row_swap = make_copy();
+        Matrix<T> col_swap = make_copy();
+        Matrix<T> update = make_copy();
+        if (N > 1) {
+            row_swap.swap_rows(0, N - 1);
+            col_swap.swap_cols(0, N - 1);
+        }
+        update.set_value(0, 0, new_value);
+        return std::chrono::duration<double, std::micro>(std::chrono::steady_clock::now() - start).count();
+    };
+    double shared_us = time_variants([&]() { return Matrix<T>(original); });
+    double deep_us = time_variants([&]() { return original.deep_copy(); });
+
+    std::cout << "\nCopy-on-write storage for Matrix 1 and its " << variants.size() << " variants:" << std::endl;
+    std::cout << "  Memory: " << shared_bytes << " bytes shared (deep copies: " << deep_bytes << " bytes)" << std::endl;
+    std::streamsize precision = std::cout.precision();
+    std::cout << "  Time to copy and modify: " << std::setprecision(1) << shared_us
+              << " us (deep copies: " << deep_us << " us)" << std::endl;
+    std::cout.precision(precision);
+}
+
 // Generic function to perform and display all operations
 template <typename T>
 void process_matrices(Matrix<T>& matrix1, Matrix<T>& matrix2, const std::string& type_name) {
@@ -34,9 +240,14 @@ void process_matrices(Matrix<T>& matrix1, Matrix<T>& matrix2, const std::string&
                   << " Major = " << major_diag_sum
                   << ", Minor = " << minor_diag_sum << std::endl;
 
+        // Copies of Matrix 1 for steps 5-7 share its rows (copy-on-write), so
+        // each one only pays for the rows its modification touches
+        Matrix<T> matrix1_row_swap = matrix1;
+        Matrix<T> matrix1_col_swap = matrix1;
+        Matrix<T> matrix1_update = matrix1;
+
         // 5. Swap rows (demonstrating on Matrix 1)
         if (N > 1) {
-            Matrix<T> matrix1_row_swap = matrix1; // Create a copy
             std::size_t row1 = 0, row2 = N - 1;
              std::cout << "\nSwapping rows " << row1 << " and " << row2 << " in Matrix 1..." << std::endl;
             matrix1_row_swap.swap_rows(row1, row2);
@@ -48,7 +259,6 @@ void process_matrices(Matrix<T>& matrix1, Matrix<T>& matrix2, const std::string&
 
         // 6. Swap columns (demonstrating on Matrix 1)
          if (N > 1) {
-            Matrix<T> matrix1_col_swap = matrix1; // Create a copy
             std::size_t col1 = 0, col2 = N - 1;
              std::cout << "\nSwapping columns " << col1 << " and " << col2 << " in Matrix 1..." << std::endl;
             matrix1_col_swap.swap_cols(col1, col2);
@@ -58,7 +268,6 @@ void process_matrices(Matrix<T>& matrix1, Matrix<T>& matrix2, const std::string&
         }
 
         // 7. Update element (demonstrating on Matrix 1)
-        Matrix<T> matrix1_update = matrix1; // Create a copy
         std::size_t update_row = 0, update_col = 0;
         T new_value;
         // Assign a noticeable value based on type
@@ -73,20 +282,47 @@ void process_matrices(Matrix<T>& matrix1, Matrix<T>& matrix2, const std::string&
         matrix1_update.set_value(update_row, update_col, new_value);
         std::cout << "Matrix 1 after Update (" << type_name << "):\n" << matrix1_update;
 
+        // 8. Storage shared by the variants above versus deep copies
+        report_copy_on_write(matrix1, { &matrix1_row_swap, &matrix1_col_swap, &matrix1_update }, new_value);
+
     } catch (const std::exception& e) {
         std::cerr << "\n*** An error occurred during processing: " << e.what() << " ***" << std::endl;
     }
+
+    // 9. LU-based operations (demonstrating on Matrix 1); kept separate so a
+    //    singular Matrix 1 does not hide the results above. Factor once and
+    //    reuse the factors for the determinant, the solve and the inverse.
+    try {
+        const auto factors = matrix1.lu();
+        std::cout << "\nMatrix 1 Determinant (" << type_name << "): " << matrix1.determinant(factors) << std::endl;
+
+        if (factors.singular) {
+            // solve() only rejects exactly zero pivots; rounding-level ones give meaningless results
+            std::cout << "\nMatrix 1 is numerically singular; skipping solve and inverse." << std::endl;
+        } else {
+            auto solution = matrix1.solve(factors, matrix2);
+            std::cout << "\nSolution X of Matrix 1 * X = Matrix 2 (" << type_name << "):\n" << solution;
+
+            auto inverse = matrix1.inverse(factors);
+            std::cout << "\nMatrix 1 Inverse (" << type_name << "):\n" << inverse;
+        }
+    } catch (const std::exception& e) {
+        std::cerr << "\n*** Could not solve with Matrix 1: " << e.what() << " ***" << std::endl;
+    }
+
+    // 10. Where this process's pages ended up, while both matrices are still live
+    report_numa_placement(matrix1.get_rows());
      std::cout << "\n--- End Processing " << type_name << " Matrices ---\n";
 }
 
 
 int main(int argc, char *argv[]) {
-    if (argc != 2) {
-        std::cerr << "Usage: " << argv[0] << " <input_filename>" << std::endl;
+    std::string filename;
+    if (!parse_options(argc, argv, filename)) {
+        print_usage(argv[0]);
         return 1;
     }
 
-    std::string filename = argv[1];
     std::ifstream inputFile(filename);
 
     if (!inputFile) {
@@ -119,6 +355,12 @@ int main(int argc, char *argv[]) {
     std::cout << "Matrix size N = " << N << std::endl;
     std::cout << "Type flag = " << type_flag << (type_flag == 0 ? " (int)" : " (double)") << std::endl;
 
+    const MatrixConfig& config = matrix_config();
+    const char* policy_names[] = { "none", "first-touch", "interleave" };
+    std::cout << "Threads = " << config.threads
+              << ", NUMA policy = " << policy_names[static_cast<int>(config.numa)]
+              << (config.pin_threads || config.numa == NumaPolicy::first_touch ? ", pinned" : "") << std::endl;
+
     try {
         if (type_flag == 0) { // Integer matrices
             Matrix<int> matrix1(N);
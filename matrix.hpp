@@ -7,141 +7,1124 @@
 #include <iomanip> // For std::setw, std::fixed, std::setprecision
 #include <numeric> // For std::accumulate (optional, can use loop)
 #include <algorithm> // For std::swap
+#include <sstream> // For std::ostringstream
+#include <fstream> // For reading /sys topology files
+#include <string>
+#include <thread> // For std::thread worker pools
+#include <mutex>
+#include <condition_variable> // For handing jobs to the worker pool
+#include <functional> // For std::function jobs
+#include <exception> // For std::exception_ptr
+#include <cstdlib> // For std::getenv
+#include <cmath> // For std::abs in pivot search
+#include <type_traits> // For std::conditional_t
+#include <limits> // For std::numeric_limits<T>::epsilon
+#include <memory> // For std::shared_ptr row storage
+#include <unordered_set> // For counting distinct shared rows
+#include <initializer_list>
+
+#ifdef __linux__
+#include <pthread.h> // For pthread_setaffinity_np
+#include <sched.h> // For sched_getaffinity, cpu_set_t
+#include <sys/syscall.h> // For SYS_set_mempolicy, SYS_get_mempolicy
+#include <unistd.h> // For syscall
+#endif
+
+// Where the rows of a matrix are placed on multi-socket (NUMA) hosts
+enum class NumaPolicy {
+    none,        // Allocate on whichever thread constructs the matrix (original behavior)
+    first_touch, // Each worker thread allocates the rows it later computes (implies pinning)
+    interleave   // Spread pages round-robin across all online NUMA nodes
+};
+
+// Inner loop used by operator*
+enum class MatmulKernel {
+    naive,  // Textbook i-j-k dot products
+    blocked // Cache-blocked i-k-j loops over block_size tiles, unrolled over k
+};
+
+// Process-wide execution settings shared by every Matrix<T>
+struct MatrixConfig {
+    unsigned threads = 1; // Worker threads used by allocation, addition and multiplication
+    NumaPolicy numa = NumaPolicy::none;
+    bool pin_threads = false; // Pin worker w to a fixed CPU so it stays next to its rows (always on for first_touch)
+    MatmulKernel kernel = MatmulKernel::blocked;
+    std::size_t block_size = 64; // Tile edge for the blocked kernel
+    std::size_t unroll = 4; // Rows of the right-hand side combined per pass (1, 2, 4 or 8)
+    std::size_t lu_panel_width = 32; // Columns factored unblocked per LU panel (independent of block_size)
+};
+
+// Profile written by matrix_tune: $MATRIX_PROFILE if set, else ./matrix_tune.profile
+inline std::string default_profile_path() {
+    const char* path = std::getenv("MATRIX_PROFILE");
+    return (path != nullptr && *path != '\0') ? path : "matrix_tune.profile";
+}
+
+// Read "key=value" lines from a tuning profile into config.
+// Unknown keys and invalid values are skipped so the defaults stay in effect.
+inline bool load_matrix_profile(const std::string& path, MatrixConfig& config) {
+    std::ifstream profile(path);
+    if (!profile) {
+        return false;
+    }
+    std::string line;
+    while (std::getline(profile, line)) {
+        std::size_t eq = line.find('=');
+        if (line.empty() || line[0] == '#' || eq == std::string::npos) {
+            continue;
+        }
+        std::string key = line.substr(0, eq);
+        std::string value = line.substr(eq + 1);
+        try {
+            if (key == "kernel") {
+                if (value == "naive") {
+                    config.kernel = MatmulKernel::naive;
+                } else if (value == "blocked") {
+                    config.kernel = MatmulKernel::blocked;
+                }
+            } else if (key == "block_size") {
+                unsigned long block = std::stoul(value);
+                if (block > 0) {
+                    config.block_size = block;
+                }
+            } else if (key == "unroll") {
+                unsigned long unroll = std::stoul(value);
+                if (unroll == 1 || unroll == 2 || unroll == 4 || unroll == 8) {
+                    config.unroll = unroll;
+                }
+            } else if (key == "lu_panel_width") {
+                unsigned long width = std::stoul(value);
+                if (width > 0) {
+                    config.lu_panel_width = width;
+                }
+            } else if (key == "threads") {
+                unsigned long threads = std::stoul(value);
+                if (threads > 0) {
+                    config.threads = static_cast<unsigned>(threads);
+                }
+            }
+        } catch (const std::exception&) {
+            // Malformed number: keep the current value
+        }
+    }
+    return true;
+}
+
+// Write the tunable fields of config as a profile readable by load_matrix_profile
+inline bool save_matrix_profile(const std::string& path, const MatrixConfig& config) {
+    std::ofstream profile(path);
+    profile << "# Generated by matrix_tune\n"
+            << "kernel=" << (config.kernel == MatmulKernel::naive ? "naive" : "blocked") << "\n"
+            << "block_size=" << config.block_size << "\n"
+            << "unroll=" << config.unroll << "\n"
+            << "lu_panel_width=" << config.lu_panel_width << "\n"
+            << "threads=" << config.threads << "\n";
+    return static_cast<bool>(profile);
+}
+
+// Access the shared configuration (modify before constructing matrices).
+// On first use the profile at default_profile_path() is loaded if present.
+inline MatrixConfig& matrix_config() {
+    static MatrixConfig config = [] {
+        MatrixConfig loaded;
+        load_matrix_profile(default_profile_path(), loaded);
+        return loaded;
+    }();
+    return config;
+}
+
+// List the online NUMA node ids, e.g. {0, 1} on a dual-socket host ({0} if unknown)
+inline std::vector<int> online_numa_nodes() {
+    std::vector<int> nodes;
+    std::ifstream online("/sys/devices/system/node/online");
+    std::string list;
+    if (online >> list) {
+        // Format is a comma separated list of ranges, e.g. "0-1,3"
+        std::istringstream ranges(list);
+        std::string range;
+        while (std::getline(ranges, range, ',')) {
+            std::size_t dash = range.find('-');
+            try {
+                int first = std::stoi(range.substr(0, dash));
+                int last = (dash == std::string::npos) ? first : std::stoi(range.substr(dash + 1));
+                for (int node = first; node <= last; ++node) {
+                    nodes.push_back(node);
+                }
+            } catch (const std::exception&) {
+                nodes.clear();
+                break;
+            }
+        }
+    }
+    if (nodes.empty()) {
+        nodes.push_back(0);
+    }
+    return nodes;
+}
+
+namespace matrix_detail {
+
+// Rows [begin, end) owned by worker w when n rows are split across `workers` threads.
+// Allocation and compute use the same split so first-touched rows stay local.
+inline std::pair<std::size_t, std::size_t> row_range(std::size_t n, unsigned workers, unsigned w) {
+    return { n * w / workers, n * (w + 1) / workers };
+}
+
+inline unsigned worker_count(std::size_t n) {
+    unsigned threads = matrix_config().threads;
+    if (threads == 0) {
+        threads = 1;
+    }
+    return n < threads ? static_cast<unsigned>(n) : threads;
+}
+
+// CPUs this process may run on, in the order the OS numbers them
+inline const std::vector<int>& allowed_cpus() {
+    static const std::vector<int> cpus = [] {
+        std::vector<int> allowed;
+#ifdef __linux__
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        if (sched_getaffinity(0, sizeof(set), &set) == 0) {
+            for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+                if (CPU_ISSET(cpu, &set)) {
+                    allowed.push_back(cpu);
+                }
+            }
+        }
+#endif
+        return allowed;
+    }();
+    return cpus;
+}
+
+// Pin the calling thread to the CPU serving worker w. CPUs are taken in the
+// order the OS numbers them, which groups cores of the same socket together,
+// so consecutive row blocks land on the same node.
+inline void pin_current_thread(unsigned w, unsigned workers) {
+#ifdef __linux__
+    const std::vector<int>& cpus = allowed_cpus();
+    if (cpus.empty()) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    CPU_SET(cpus[static_cast<std::size_t>(w) * cpus.size() / workers], &set);
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set); // Best effort
+#else
+    (void)w;
+    (void)workers;
+#endif
+}
+
+// Let the calling thread run on every allowed CPU again
+inline void unpin_current_thread() {
+#ifdef __linux__
+    const std::vector<int>& cpus = allowed_cpus();
+    if (cpus.empty()) {
+        return;
+    }
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    for (int cpu : cpus) {
+        CPU_SET(cpu, &set);
+    }
+    pthread_setaffinity_np(pthread_self(), sizeof(set), &set); // Best effort
+#endif
+}
+
+// Long-lived worker threads shared by every parallel_rows call. Thread w
+// always serves worker index w, and it is pinned once per worker count
+// rather than on every call, so it stays on the CPU (and node) of the rows
+// it first-touched. Threads are started on demand and joined at exit.
+class WorkerPool {
+private:
+    struct Job {
+        const std::function<void(unsigned)>* fn = nullptr;
+        unsigned workers = 0;
+        bool pin = false;
+    };
+
+    std::mutex run_mutex; // One job at a time; other callers wait their turn
+    std::mutex mutex;
+    std::condition_variable wake;
+    std::condition_variable done;
+    std::vector<std::thread> threads;
+    std::vector<std::exception_ptr> errors;
+    Job job;
+    std::size_t generation = 0; // Bumped for every job so idle workers notice it
+    unsigned pending = 0;
+    bool stopping = false;
+
+    void serve(unsigned w) {
+        inside_worker() = true;
+        unsigned pinned_for = 0; // Worker count this thread is pinned for, 0 if unpinned
+        std::size_t seen = 0;
+        for (;;) {
+            Job current;
+            {
+                std::unique_lock<std::mutex> lock(mutex);
+                wake.wait(lock, [&] { return stopping || generation != seen; });
+                if (stopping) {
+                    return;
+                }
+                seen = generation;
+                if (w >= job.workers) {
+                    continue; // Not needed for this job
+                }
+                current = job;
+            }
+            if (current.pin && pinned_for != current.workers) {
+                pin_current_thread(w, current.workers);
+                pinned_for = current.workers;
+            } else if (!current.pin && pinned_for != 0) {
+                unpin_current_thread();
+                pinned_for = 0;
+            }
+            std::exception_ptr error;
+            try {
+                (*current.fn)(w);
+            } catch (...) {
+                error = std::current_exception();
+            }
+            std::lock_guard<std::mutex> lock(mutex);
+            errors[w] = error;
+            if (--pending == 0) {
+                done.notify_one();
+            }
+        }
+    }
+
+public:
+    WorkerPool() = default;
+    WorkerPool(const WorkerPool&) = delete;
+    WorkerPool& operator=(const WorkerPool&) = delete;
+
+    ~WorkerPool() {
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            stopping = true;
+        }
+        wake.notify_all();
+        for (auto& thread : threads) {
+            thread.join();
+        }
+    }
+
+    // True on pool threads; a nested parallel_rows call there runs inline
+    static bool& inside_worker() {
+        static thread_local bool inside = false;
+        return inside;
+    }
+
+    // Run fn(w) for w in [0, workers) on pool threads and wait for all of them.
+    // The first exception thrown by a worker is rethrown here.
+    void run(unsigned workers, bool pin, const std::function<void(unsigned)>& fn) {
+        std::lock_guard<std::mutex> serial(run_mutex);
+        while (threads.size() < workers) {
+            unsigned w = static_cast<unsigned>(threads.size());
+            threads.emplace_back([this, w] { serve(w); });
+        }
+        {
+            std::lock_guard<std::mutex> lock(mutex);
+            job = Job{ &fn, workers, pin };
+            errors.assign(workers, nullptr);
+            pending = workers;
+            ++generation;
+        }
+        wake.notify_all();
+        std::unique_lock<std::mutex> lock(mutex);
+        done.wait(lock, [&] { return pending == 0; });
+        for (const auto& error : errors) {
+            if (error) {
+                std::rethrow_exception(error);
+            }
+        }
+    }
+};
+
+inline WorkerPool& worker_pool() {
+    static WorkerPool pool;
+    return pool;
+}
+
+// Run fn(begin, end) over [0, n) split into contiguous row blocks, one per worker
+template <typename Fn>
+void parallel_rows(std::size_t n, Fn&& fn) {
+    unsigned workers = worker_count(n);
+    if (workers <= 1 || WorkerPool::inside_worker()) {
+        fn(std::size_t{0}, n);
+        return;
+    }
+    // First-touch placement is only meaningful if a worker cannot migrate away from its rows
+    const MatrixConfig& config = matrix_config();
+    bool pin = config.pin_threads || config.numa == NumaPolicy::first_touch;
+    std::function<void(unsigned)> job = [&](unsigned w) {
+        auto range = row_range(n, workers, w);
+        fn(range.first, range.second);
+    };
+    worker_pool().run(workers, pin, job);
+}
+
+// Applies the interleave policy to allocations made by this thread while in
+// scope, then puts back whatever policy the thread had before (for example
+// one inherited from numactl --membind)
+class ScopedMemPolicy {
+private:
+    bool active = false;
+    int previous_mode = 0; // MPOL_DEFAULT unless get_mempolicy says otherwise
+    std::vector<unsigned long> previous_mask;
+
+    // Large enough for the kernel's MAX_NUMNODES (1024 on common distributions)
+    static constexpr std::size_t mask_bits = 1024;
+
+public:
+    explicit ScopedMemPolicy(NumaPolicy policy) {
+#ifdef __linux__
+        if (policy != NumaPolicy::interleave) {
+            return;
+        }
+        const int MPOL_INTERLEAVE_MODE = 3;
+        const std::size_t bits = sizeof(unsigned long) * 8;
+        previous_mask.assign(mask_bits / bits, 0);
+        if (syscall(SYS_get_mempolicy, &previous_mode, previous_mask.data(), mask_bits, nullptr, 0UL) != 0) {
+            // Unknown previous policy: the destructor falls back to MPOL_DEFAULT
+            previous_mode = 0;
+            previous_mask.clear();
+        }
+        std::vector<unsigned long> mask(1);
+        for (int node : online_numa_nodes()) {
+            std::size_t word = static_cast<std::size_t>(node) / bits;
+            if (word >= mask.size()) {
+                mask.resize(word + 1);
+            }
+            mask[word] |= 1UL << (static_cast<std::size_t>(node) % bits);
+        }
+        // Keeps the current policy silently if the kernel refuses
+        active = syscall(SYS_set_mempolicy, MPOL_INTERLEAVE_MODE, mask.data(), mask.size() * bits + 1) == 0;
+#else
+        (void)policy;
+#endif
+    }
+
+    ~ScopedMemPolicy() {
+#ifdef __linux__
+        if (active) {
+            const int MPOL_DEFAULT_MODE = 0;
+            if (previous_mode == MPOL_DEFAULT_MODE ||
+                syscall(SYS_set_mempolicy, previous_mode, previous_mask.data(), mask_bits + 1) != 0) {
+                syscall(SYS_set_mempolicy, MPOL_DEFAULT_MODE, nullptr, 0);
+            }
+        }
+#endif
+    }
+
+    ScopedMemPolicy(const ScopedMemPolicy&) = delete;
+    ScopedMemPolicy& operator=(const ScopedMemPolicy&) = delete;
+};
+
+// Naive kernel: c[i][j] += dot(row i of a, column j of b) for rows [row_begin, row_end)
+template <typename T>
+void gemm_rows_naive(const T* const* a, const T* const* b, T* const* c,
+                     std::size_t row_begin, std::size_t row_end, std::size_t inner, std::size_t cols) {
+    for (std::size_t i = row_begin; i < row_end; ++i) {
+        for (std::size_t j = 0; j < cols; ++j) {
+            T sum = 0; // Use T for the sum type
+            for (std::size_t k = 0; k < inner; ++k) {
+                sum += a[i][k] * b[k][j];
+            }
+            c[i][j] += sum;
+        }
+    }
+}
+
+// Blocked kernel: same contract as gemm_rows_naive. Tiles keep a block x block
+// piece of b in cache while it is reused by every row of the tile, and U rows of
+// b are folded into each pass over a c row. Products are still summed in
+// increasing k, but the compiler may contract the unrolled multiply-adds into
+// FMAs differently from the naive loop, so results agree only up to rounding.
+template <typename T, std::size_t U>
+void gemm_rows_blocked(const T* const* a, const T* const* b, T* const* c,
+                       std::size_t row_begin, std::size_t row_end, std::size_t inner, std::size_t cols,
+                       std::size_t block) {
+    for (std::size_t ii = row_begin; ii < row_end; ii += block) {
+        std::size_t i_end = std::min(ii + block, row_end);
+        for (std::size_t kk = 0; kk < inner; kk += block) {
+            std::size_t k_end = std::min(kk + block, inner);
+            for (std::size_t jj = 0; jj < cols; jj += block) {
+                std::size_t j_end = std::min(jj + block, cols);
+                for (std::size_t i = ii; i < i_end; ++i) {
+                    const T* a_row = a[i];
+                    T* c_row = c[i];
+                    std::size_t k = kk;
+                    for (; k + U <= k_end; k += U) {
+                        T a_k[U];
+                        const T* b_k[U];
+                        for (std::size_t u = 0; u < U; ++u) {
+                            a_k[u] = a_row[k + u];
+                            b_k[u] = b[k + u];
+                        }
+                        for (std::size_t j = jj; j < j_end; ++j) {
+                            T sum = c_row[j];
+                            for (std::size_t u = 0; u < U; ++u) {
+                                sum += a_k[u] * b_k[u][j];
+                            }
+                            c_row[j] = sum;
+                        }
+                    }
+                    for (; k < k_end; ++k) {
+                        T a_ik = a_row[k];
+                        const T* b_row = b[k];
+                        for (std::size_t j = jj; j < j_end; ++j) {
+                            c_row[j] += a_ik * b_row[j];
+                        }
+                    }
+                }
+            }
+        }
+    }
+}
+
+// Matrix-vector kernel: store(i, dot(row i of a, x)) for every row i.
+// Each row of a is streamed exactly once while x stays in cache; four
+// independent partial sums keep loads in flight instead of waiting on one
+// dependent add chain, which is what bounds a memory-bound GEMV.
+template <typename T, typename Store>
+void gemv(const T* const* a, const T* x, std::size_t rows, std::size_t cols, Store&& store) {
+    parallel_rows(rows, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; ++i) {
+            const T* a_row = a[i];
+            T s0 = 0, s1 = 0, s2 = 0, s3 = 0;
+            std::size_t k = 0;
+            for (; k + 4 <= cols; k += 4) {
+                s0 += a_row[k] * x[k];
+                s1 += a_row[k + 1] * x[k + 1];
+                s2 += a_row[k + 2] * x[k + 2];
+                s3 += a_row[k + 3] * x[k + 3];
+            }
+            for (; k < cols; ++k) {
+                s0 += a_row[k] * x[k];
+            }
+            store(i, (s0 + s1) + (s2 + s3));
+        }
+    });
+}
+
+// c += a * b where a is rows x inner and b is inner x cols, given as row pointers.
+// Rows of c are split across workers and the kernel comes from matrix_config().
+template <typename T>
+void gemm(const T* const* a, const T* const* b, T* const* c,
+          std::size_t rows, std::size_t inner, std::size_t cols) {
+    const MatrixConfig& config = matrix_config();
+    MatmulKernel kernel = config.kernel;
+    std::size_t block = config.block_size > 0 ? config.block_size : 64;
+    std::size_t unroll = config.unroll;
+    parallel_rows(rows, [&](std::size_t begin, std::size_t end) {
+        if (kernel == MatmulKernel::naive) {
+            gemm_rows_naive(a, b, c, begin, end, inner, cols);
+            return;
+        }
+        switch (unroll) {
+            case 8: gemm_rows_blocked<T, 8>(a, b, c, begin, end, inner, cols, block); break;
+            case 4: gemm_rows_blocked<T, 4>(a, b, c, begin, end, inner, cols, block); break;
+            case 2: gemm_rows_blocked<T, 2>(a, b, c, begin, end, inner, cols, block); break;
+            default: gemm_rows_blocked<T, 1>(a, b, c, begin, end, inner, cols, block); break;
+        }
+    });
+}
+
+} // namespace matrix_detail
+
+template <typename T>
+class Matrix;
+
+// Result of Matrix::lu(): P * A = L * U with the factors packed into one matrix
+template <typename F>
+struct LUDecomposition {
+    Matrix<F> lu; // L strictly below the diagonal (unit diagonal implied), U on and above it
+    std::vector<std::size_t> pivots; // Row i of lu came from row pivots[i] of A
+    int sign; // Parity of the row permutation (+1 or -1)
+    bool singular; // Advisory: a pivot vanished relative to its column of A (numerically singular)
+};
 
 template <typename T>
 class Matrix {
 private:
-    std::size_t size_n; // Store N (size x size)
-    std::vector<std::vector<T>> data;
+    template <typename U> friend class Matrix;
+
+    std::size_t n_rows; // Store M (rows x cols); equal to n_cols for square matrices
+    std::size_t n_cols;
+    // Copy-on-write storage: a shared table of shared rows. Copying a Matrix
+    // copies one pointer; a write clones the table (row pointers only) and then
+    // just the row it touches, so a variant differing in one row costs one row.
+    using Row = std::vector<T>;
+    using RowTable = std::vector<std::shared_ptr<Row>>;
+    std::shared_ptr<RowTable> data;
 
     // Helper to check bounds
     void check_bounds(std::size_t r, std::size_t c) const {
-        if (r >= size_n || c >= size_n) {
+        if (r >= n_rows || c >= n_cols) {
             throw std::out_of_range("Matrix index out of bounds");
         }
     }
 
+    // Allocate zeroed rows according to the configured NUMA policy
+    void allocate_rows() {
+        const MatrixConfig& config = matrix_config();
+        data = std::make_shared<RowTable>(n_rows);
+        RowTable& table = *data;
+        matrix_detail::ScopedMemPolicy policy(config.numa);
+        if (config.numa == NumaPolicy::first_touch) {
+            // Rows are allocated and zeroed by the worker that will compute them
+            matrix_detail::parallel_rows(n_rows, [&table, this](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; ++i) {
+                    table[i] = std::make_shared<Row>(n_cols);
+                }
+            });
+        } else {
+            for (auto& row : table) {
+                row = std::make_shared<Row>(n_cols);
+            }
+        }
+    }
+
+    // Read-only view of row i
+    const T* row(std::size_t i) const {
+        return (*data)[i]->data();
+    }
+
+    // Give this matrix its own row table (row buffers stay shared)
+    void detach_table() {
+        if (data.use_count() != 1) {
+            data = std::make_shared<RowTable>(*data);
+        }
+    }
+
+    // Writable view of row i, cloning the row first if another matrix shares it.
+    // The clone honors the interleave policy; under first_touch a single-row
+    // clone lands on the writing thread's node (bulk writes go through
+    // mutable_row_pointers, which clones on the owning workers).
+    // Not safe to call concurrently on one matrix; take mutable_row_pointers()
+    // before handing rows to worker threads.
+    T* mutable_row(std::size_t i) {
+        detach_table();
+        std::shared_ptr<Row>& shared = (*data)[i];
+        if (shared.use_count() != 1) {
+            matrix_detail::ScopedMemPolicy policy(matrix_config().numa);
+            shared = std::make_shared<Row>(*shared);
+        }
+        return shared->data();
+    }
+
+    // Raw pointers to the start of each row, as taken by the matrix_detail kernels
+    std::vector<const T*> row_pointers() const {
+        std::vector<const T*> rows(n_rows);
+        for (std::size_t i = 0; i < n_rows; ++i) {
+            rows[i] = row(i);
+        }
+        return rows;
+    }
+
+    // Writable pointers to every row; shared rows are cloned under the NUMA
+    // policy, on the worker that owns them for first_touch
+    std::vector<T*> mutable_row_pointers() {
+        detach_table();
+        const MatrixConfig& config = matrix_config();
+        RowTable& table = *data;
+        std::vector<T*> rows(n_rows);
+        auto clone_shared = [&table, &rows](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                if (table[i].use_count() != 1) {
+                    table[i] = std::make_shared<Row>(*table[i]);
+                }
+                rows[i] = table[i]->data();
+            }
+        };
+        bool any_shared = std::any_of(table.begin(), table.end(),
+                                      [](const std::shared_ptr<Row>& shared) { return shared.use_count() != 1; });
+        if (!any_shared) {
+            clone_shared(0, n_rows); // Fresh matrices: just collect the pointers
+        } else if (config.numa == NumaPolicy::first_touch) {
+            matrix_detail::parallel_rows(n_rows, clone_shared);
+        } else {
+            matrix_detail::ScopedMemPolicy policy(config.numa);
+            clone_shared(0, n_rows);
+        }
+        return rows;
+    }
+
+    // Factor this square matrix in place into packed L\U with partial pivoting.
+    // Blocked right-looking variant: each panel of lu_panel_width columns is
+    // factored unblocked, the row block to its right is solved against the
+    // unit-lower panel, and the trailing submatrix takes the rank-nb update
+    // through the GEMM kernel, which carries almost all the FLOPs. The panel
+    // is O(n * nb^2) serial work, so nb is kept well below a GEMM tile.
+    void factor_in_place(std::vector<std::size_t>& pivots, int& sign, bool& singular) {
+        const std::size_t n = n_rows;
+        const MatrixConfig& config = matrix_config();
+        const std::size_t nb = config.lu_panel_width > 0 ? config.lu_panel_width : 32;
+        pivots.resize(n);
+        for (std::size_t i = 0; i < n; ++i) {
+            pivots[i] = i;
+        }
+        sign = 1;
+        singular = false;
+        std::vector<T*> r = mutable_row_pointers();
+
+        // A pivot at rounding-error level of the largest entry in its own column
+        // flags the matrix as numerically singular. Scaling per column keeps
+        // well-conditioned but badly scaled matrices (e.g. diag(1e10, 1e-10))
+        // from being flagged; row permutations do not change column contents.
+        std::vector<T> tolerance(n, T{0});
+        for (std::size_t i = 0; i < n; ++i) {
+            for (std::size_t j = 0; j < n; ++j) {
+                tolerance[j] = std::max(tolerance[j], static_cast<T>(std::abs(r[i][j])));
+            }
+        }
+        for (T& column_tolerance : tolerance) {
+            column_tolerance *= static_cast<T>(n) * std::numeric_limits<T>::epsilon();
+        }
+
+        for (std::size_t k0 = 0; k0 < n; k0 += nb) {
+            const std::size_t k_end = std::min(k0 + nb, n);
+
+            // Panel: columns [k0, k_end), rows [k0, n)
+            for (std::size_t j = k0; j < k_end; ++j) {
+                std::size_t p = j;
+                for (std::size_t i = j + 1; i < n; ++i) {
+                    if (std::abs(r[i][j]) > std::abs(r[p][j])) {
+                        p = i;
+                    }
+                }
+                if (std::abs(r[p][j]) <= tolerance[j]) {
+                    singular = true;
+                }
+                if (r[p][j] == T{0}) {
+                    continue; // Nothing to eliminate below a zero column
+                }
+                if (p != j) {
+                    swap_rows(j, p); // Swaps whole rows, so every column is permuted at once
+                    std::swap(r[j], r[p]);
+                    std::swap(pivots[j], pivots[p]);
+                    sign = -sign;
+                }
+                const T pivot = r[j][j];
+                for (std::size_t i = j + 1; i < n; ++i) {
+                    T l = r[i][j] / pivot;
+                    r[i][j] = l;
+                    for (std::size_t c = j + 1; c < k_end; ++c) {
+                        r[i][c] -= l * r[j][c];
+                    }
+                }
+            }
+            if (k_end == n) {
+                break;
+            }
+
+            // U12 = L11^-1 * A12, split across workers by column
+            const std::size_t trailing = n - k_end;
+            matrix_detail::parallel_rows(trailing, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t j = k0; j < k_end; ++j) {
+                    for (std::size_t i = j + 1; i < k_end; ++i) {
+                        const T l = r[i][j];
+                        for (std::size_t c = k_end + begin; c < k_end + end; ++c) {
+                            r[i][c] -= l * r[j][c];
+                        }
+                    }
+                }
+            });
+
+            // A22 -= L21 * U12: the kernel accumulates, so feed it -L21
+            const std::size_t kb = k_end - k0;
+            std::vector<T> neg_l21(trailing * kb);
+            std::vector<const T*> a(trailing);
+            std::vector<const T*> b(kb);
+            std::vector<T*> c(trailing);
+            for (std::size_t i = 0; i < trailing; ++i) {
+                for (std::size_t k = 0; k < kb; ++k) {
+                    neg_l21[i * kb + k] = -r[k_end + i][k0 + k];
+                }
+                a[i] = neg_l21.data() + i * kb;
+                c[i] = r[k_end + i] + k_end;
+            }
+            for (std::size_t k = 0; k < kb; ++k) {
+                b[k] = r[k0 + k] + k_end;
+            }
+            matrix_detail::gemm(a.data(), b.data(), c.data(), trailing, kb, trailing);
+        }
+    }
+
+    // Factors passed to determinant/solve/inverse must come from lu() on a
+    // matrix of this size; the permutation and packed L\U are used as is
+    template <typename F>
+    void check_factors(const LUDecomposition<F>& factors) const {
+        if (!is_square()) {
+            throw std::invalid_argument("LU-based operations require a square matrix.");
+        }
+        if (factors.lu.get_rows() != n_rows || factors.pivots.size() != n_rows) {
+            throw std::invalid_argument("LU factors do not match the matrix dimensions.");
+        }
+    }
+
 public:
+    // Floating-point type used by LU-based operations (integer matrices are factored in double)
+    using lu_type = std::conditional_t<std::is_floating_point_v<T>, T, double>;
+
     // Constructor: Creates an N x N matrix initialized with default T (e.g., 0 for int/double)
-    Matrix(std::size_t N) : size_n(N), data(N, std::vector<T>(N)) {
-        if (N == 0) {
+    Matrix(std::size_t N) : Matrix(N, N) {}
+
+    // Constructor: Creates a rows x cols matrix initialized with default T
+    Matrix(std::size_t rows, std::size_t cols) : n_rows(rows), n_cols(cols) {
+        if (rows == 0 || cols == 0) {
              throw std::invalid_argument("Matrix size must be positive.");
         }
+        allocate_rows();
     }
 
     // Constructor: Creates a matrix from existing 2D vector data
-    Matrix(const std::vector<std::vector<T>>& initial_data) : data(initial_data) {
+    Matrix(const std::vector<std::vector<T>>& initial_data) {
         if (initial_data.empty() || initial_data[0].empty()) {
             // Handle empty input if necessary, or assume valid input based on context
              throw std::invalid_argument("Initial data cannot be empty.");
         }
-        size_n = initial_data.size();
-        // Validate if it's a square matrix
-        for (const auto& row : data) {
-            if (row.size() != size_n) {
-                throw std::invalid_argument("Input data must form a square matrix.");
+        n_rows = initial_data.size();
+        n_cols = initial_data[0].size();
+        // Validate that every row has the same length
+        for (const auto& source : initial_data) {
+            if (source.size() != n_cols) {
+                throw std::invalid_argument("Input data rows must all have the same length.");
             }
         }
+        // Place the rows like any new matrix, then copy the values in
+        allocate_rows();
+        std::vector<T*> dst = mutable_row_pointers();
+        matrix_detail::parallel_rows(n_rows, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                std::copy(initial_data[i].begin(), initial_data[i].end(), dst[i]);
+            }
+        });
     }
 
-    // Get the size (N) of the matrix
+    // Constructor: Creates a matrix from a brace literal such as {{1}, {2}}.
+    // Without it that literal is ambiguous with Matrix(Matrix(rows, cols)).
+    Matrix(std::initializer_list<std::vector<T>> initial_data)
+        : Matrix(std::vector<std::vector<T>>(initial_data)) {}
+
+    // Get the size (N) of a square matrix; for rectangular matrices this is the row count
     std::size_t get_size() const {
-        return size_n;
+        return n_rows;
+    }
+
+    // Get the number of rows (M)
+    std::size_t get_rows() const {
+        return n_rows;
+    }
+
+    // Get the number of columns
+    std::size_t get_cols() const {
+        return n_cols;
+    }
+
+    bool is_square() const {
+        return n_rows == n_cols;
+    }
+
+    // Copy with its own storage for every row, i.e. what a copy cost before
+    // copy-on-write; rows are placed by the NUMA policy like a new matrix
+    Matrix deep_copy() const {
+        Matrix copy(n_rows, n_cols);
+        std::vector<const T*> src = row_pointers();
+        std::vector<T*> dst = copy.mutable_row_pointers();
+        matrix_detail::parallel_rows(n_rows, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                std::copy(src[i], src[i] + n_cols, dst[i]);
+            }
+        });
+        return copy;
+    }
+
+    // Bytes of element storage held by a set of matrices, counting each row
+    // buffer once no matter how many of them share it
+    static std::size_t storage_bytes(const std::vector<const Matrix*>& matrices) {
+        std::unordered_set<const Row*> seen;
+        std::size_t bytes = 0;
+        for (const Matrix* matrix : matrices) {
+            for (const auto& shared : *matrix->data) {
+                if (seen.insert(shared.get()).second) {
+                    bytes += shared->size() * sizeof(T);
+                }
+            }
+        }
+        return bytes;
+    }
+
+    // Bytes of element storage referenced by this matrix
+    std::size_t storage_bytes() const {
+        return storage_bytes({ this });
     }
 
     // Set value at (i, j)
     void set_value(std::size_t i, std::size_t j, T value) {
         check_bounds(i, j);
-        data[i][j] = value;
+        mutable_row(i)[j] = value;
     }
 
     // Get value at (i, j)
     T get_value(std::size_t i, std::size_t j) const {
         check_bounds(i, j);
-        return data[i][j];
+        return row(i)[j];
     }
 
     // Overload operator+ for matrix addition
     Matrix operator+(const Matrix& rhs) const {
-        if (size_n != rhs.size_n) {
+        if (n_rows != rhs.n_rows || n_cols != rhs.n_cols) {
             throw std::invalid_argument("Matrices must have the same dimensions for addition.");
         }
-        Matrix result(size_n);
-        for (std::size_t i = 0; i < size_n; ++i) {
-            for (std::size_t j = 0; j < size_n; ++j) {
-                result.data[i][j] = data[i][j] + rhs.data[i][j];
+        Matrix result(n_rows, n_cols);
+        std::vector<const T*> a = row_pointers();
+        std::vector<const T*> b = rhs.row_pointers();
+        std::vector<T*> c = result.mutable_row_pointers();
+        matrix_detail::parallel_rows(n_rows, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                for (std::size_t j = 0; j < n_cols; ++j) {
+                    c[i][j] = a[i][j] + b[i][j];
+                }
             }
-        }
+        });
         return result;
     }
 
-    // Overload operator* for matrix multiplication
+    // Overload operator* for matrix multiplication: (M x K) * (K x N) gives M x N
     Matrix operator*(const Matrix& rhs) const {
-        if (size_n != rhs.size_n) {
-            throw std::invalid_argument("Matrices must have the same dimensions for multiplication.");
+        if (n_cols != rhs.n_rows) {
+            throw std::invalid_argument("Matrices must have matching inner dimensions for multiplication.");
         }
-        Matrix result(size_n); // Initialize with zeros
-        for (std::size_t i = 0; i < size_n; ++i) {
-            for (std::size_t j = 0; j < size_n; ++j) {
-                T sum = 0; // Use T for the sum type
-                for (std::size_t k = 0; k < size_n; ++k) {
-                    sum += data[i][k] * rhs.data[k][j];
-                }
-                result.data[i][j] = sum;
+        Matrix result(n_rows, rhs.n_cols); // Initialize with zeros
+        std::vector<const T*> a = row_pointers();
+        if (rhs.n_cols == 1) {
+            // A single column is a matrix-vector product; use the GEMV kernel
+            std::vector<T> x(n_cols);
+            for (std::size_t k = 0; k < n_cols; ++k) {
+                x[k] = rhs.row(k)[0];
             }
+            std::vector<T*> y = result.mutable_row_pointers();
+            matrix_detail::gemv(a.data(), x.data(), n_rows, n_cols, [&](std::size_t i, T value) { y[i][0] = value; });
+            return result;
         }
+        // Each worker computes the result rows it first-touched (see allocate_rows)
+        std::vector<const T*> b = rhs.row_pointers();
+        std::vector<T*> c = result.mutable_row_pointers();
+        matrix_detail::gemm(a.data(), b.data(), c.data(), n_rows, n_cols, rhs.n_cols);
         return result;
     }
 
+    // Matrix-vector product: (M x K) * vector of length K gives a vector of length M
+    std::vector<T> operator*(const std::vector<T>& x) const {
+        if (x.size() != n_cols) {
+            throw std::invalid_argument("Vector length must match the matrix column count for multiplication.");
+        }
+        std::vector<T> y(n_rows);
+        std::vector<const T*> a = row_pointers();
+        matrix_detail::gemv(a.data(), x.data(), n_rows, n_cols, [&](std::size_t i, T value) { y[i] = value; });
+        return y;
+    }
+
     // Calculate sum of main diagonal elements
     T sum_diagonal_major() const {
+        if (!is_square()) {
+            throw std::invalid_argument("Diagonal sums require a square matrix.");
+        }
         T sum = 0;
-        for (std::size_t i = 0; i < size_n; ++i) {
-            sum += data[i][i];
+        for (std::size_t i = 0; i < n_rows; ++i) {
+            sum += row(i)[i];
         }
         return sum;
     }
 
     // Calculate sum of secondary diagonal elements
     T sum_diagonal_minor() const {
+        if (!is_square()) {
+            throw std::invalid_argument("Diagonal sums require a square matrix.");
+        }
         T sum = 0;
-        for (std::size_t i = 0; i < size_n; ++i) {
-            sum += data[i][size_n - 1 - i];
+        for (std::size_t i = 0; i < n_rows; ++i) {
+            sum += row(i)[n_cols - 1 - i];
         }
         return sum;
     }
 
     // Swap two rows
     void swap_rows(std::size_t r1, std::size_t r2) {
-        if (r1 >= size_n || r2 >= size_n) {
+        if (r1 >= n_rows || r2 >= n_rows) {
             throw std::out_of_range("Row index out of bounds for swapping.");
         }
         if (r1 != r2) {
-            std::swap(data[r1], data[r2]);
+            // Only the row pointers move; no row data is copied even if shared
+            detach_table();
+            std::swap((*data)[r1], (*data)[r2]);
         }
     }
 
     // Swap two columns
     void swap_cols(std::size_t c1, std::size_t c2) {
-        if (c1 >= size_n || c2 >= size_n) {
+        if (c1 >= n_cols || c2 >= n_cols) {
             throw std::out_of_range("Column index out of bounds for swapping.");
         }
         if (c1 != c2) {
-            for (std::size_t i = 0; i < size_n; ++i) {
-                std::swap(data[i][c1], data[i][c2]);
+            std::vector<T*> rows = mutable_row_pointers(); // Clones every shared row
+            for (std::size_t i = 0; i < n_rows; ++i) {
+                std::swap(rows[i][c1], rows[i][c2]);
             }
         }
     }
 
+    // LU decomposition with partial pivoting (square matrices only)
+    LUDecomposition<lu_type> lu() const {
+        if (!is_square()) {
+            throw std::invalid_argument("LU decomposition requires a square matrix.");
+        }
+        Matrix<lu_type> work(n_rows, n_cols);
+        for (std::size_t i = 0; i < n_rows; ++i) {
+            const T* src = row(i);
+            lu_type* dst = work.mutable_row(i);
+            for (std::size_t j = 0; j < n_cols; ++j) {
+                dst[j] = static_cast<lu_type>(src[j]);
+            }
+        }
+        LUDecomposition<lu_type> result{ std::move(work), {}, 1, false };
+        result.lu.factor_in_place(result.pivots, result.sign, result.singular);
+        return result;
+    }
+
+    // Determinant from the LU factors: sign * prod(U_ii), 0 if a pivot is exactly zero
+    lu_type determinant() const {
+        return determinant(lu());
+    }
+
+    // Determinant reusing factors already computed by lu() on this matrix
+    lu_type determinant(const LUDecomposition<lu_type>& factors) const {
+        check_factors(factors);
+        lu_type det = static_cast<lu_type>(factors.sign);
+        for (std::size_t i = 0; i < n_rows; ++i) {
+            const lu_type pivot = factors.lu.row(i)[i];
+            if (pivot == lu_type{0}) {
+                return lu_type{0}; // Plain zero, not sign * 0 (which prints as -0.00)
+            }
+            det *= pivot;
+        }
+        return det;
+    }
+
+    // Solve A * X = B for X, where B has as many rows as A
+    Matrix<lu_type> solve(const Matrix& rhs) const {
+        if (rhs.n_rows != n_rows) {
+            throw std::invalid_argument("Right-hand side must have as many rows as the matrix.");
+        }
+        return solve(lu(), rhs);
+    }
+
+    // Solve A * X = B reusing factors already computed by lu() on this matrix
+    Matrix<lu_type> solve(const LUDecomposition<lu_type>& factors, const Matrix& rhs) const {
+        check_factors(factors);
+        if (rhs.n_rows != n_rows) {
+            throw std::invalid_argument("Right-hand side must have as many rows as the matrix.");
+        }
+        // Only an exactly zero pivot makes the system unsolvable; callers that
+        // care about conditioning can check the advisory factors.singular flag
+        for (std::size_t i = 0; i < n_rows; ++i) {
+            if (factors.lu.row(i)[i] == lu_type{0}) {
+                throw std::runtime_error("Matrix is singular.");
+            }
+        }
+        const std::size_t n = n_rows;
+        const std::size_t m = rhs.n_cols;
+        Matrix<lu_type> x(n, m);
+        for (std::size_t i = 0; i < n; ++i) {
+            const T* src = rhs.row(factors.pivots[i]);
+            lu_type* dst = x.mutable_row(i);
+            for (std::size_t j = 0; j < m; ++j) {
+                dst[j] = static_cast<lu_type>(src[j]);
+            }
+        }
+        std::vector<const lu_type*> f = factors.lu.row_pointers();
+        std::vector<lu_type*> xr = x.mutable_row_pointers();
+        // Forward (L y = P b) then back (U x = y) substitution, split by right-hand-side column
+        matrix_detail::parallel_rows(m, [&](std::size_t begin, std::size_t end) {
+            for (std::size_t i = 1; i < n; ++i) {
+                for (std::size_t k = 0; k < i; ++k) {
+                    const lu_type l = f[i][k];
+                    for (std::size_t j = begin; j < end; ++j) {
+                        xr[i][j] -= l * xr[k][j];
+                    }
+                }
+            }
+            for (std::size_t i = n; i-- > 0;) {
+                for (std::size_t k = i + 1; k < n; ++k) {
+                    const lu_type u = f[i][k];
+                    for (std::size_t j = begin; j < end; ++j) {
+                        xr[i][j] -= u * xr[k][j];
+                    }
+                }
+                for (std::size_t j = begin; j < end; ++j) {
+                    xr[i][j] /= f[i][i];
+                }
+            }
+        });
+        return x;
+    }
+
+    // Solve A * x = b for a single right-hand-side vector
+    std::vector<lu_type> solve(const std::vector<T>& b) const {
+        if (b.size() != n_rows) {
+            throw std::invalid_argument("Right-hand side must have as many rows as the matrix.");
+        }
+        return solve(lu(), b);
+    }
+
+    // Solve A * x = b reusing factors already computed by lu() on this matrix
+    std::vector<lu_type> solve(const LUDecomposition<lu_type>& factors, const std::vector<T>& b) const {
+        if (b.size() != n_rows) {
+            throw std::invalid_argument("Right-hand side must have as many rows as the matrix.");
+        }
+        Matrix column(n_rows, 1);
+        for (std::size_t i = 0; i < n_rows; ++i) {
+            column.mutable_row(i)[0] = b[i];
+        }
+        Matrix<lu_type> x = solve(factors, column);
+        std::vector<lu_type> result(n_rows);
+        for (std::size_t i = 0; i < n_rows; ++i) {
+            result[i] = x.row(i)[0];
+        }
+        return result;
+    }
+
+    // Inverse, computed as the solution of A * X = I
+    Matrix<lu_type> inverse() const {
+        if (!is_square()) {
+            throw std::invalid_argument("Only square matrices can be inverted.");
+        }
+        return inverse(lu());
+    }
+
+    // Inverse reusing factors already computed by lu() on this matrix
+    Matrix<lu_type> inverse(const LUDecomposition<lu_type>& factors) const {
+        check_factors(factors);
+        Matrix identity(n_rows, n_cols);
+        for (std::size_t i = 0; i < n_rows; ++i) {
+            identity.mutable_row(i)[i] = T{1};
+        }
+        return solve(factors, identity);
+    }
+
     // Friend function to overload operator<< for printing
     friend std::ostream& operator<<(std::ostream& os, const Matrix<T>& matrix) {
         // Determine max width for alignment (optional, but good for clean output)
         int max_width = 0;
-        for (std::size_t i = 0; i < matrix.size_n; ++i) {
-            for (std::size_t j = 0; j < matrix.size_n; ++j) {
+        for (std::size_t i = 0; i < matrix.n_rows; ++i) {
+            for (std::size_t j = 0; j < matrix.n_cols; ++j) {
                 std::ostringstream oss;
                  // Print as double for consistent formatting if needed, or use T
-                oss << std::fixed << std::setprecision(2) << static_cast<double>(matrix.data[i][j]);
+                oss << std::fixed << std::setprecision(2) << static_cast<double>(matrix.row(i)[j]);
                 if (oss.str().length() > max_width) {
                     max_width = oss.str().length();
                 }
@@ -151,10 +1134,10 @@ public:
         max_width += 2;
 
         os << std::fixed << std::setprecision(2); // Set precision for floating point types
-        for (std::size_t i = 0; i < matrix.size_n; ++i) {
-            for (std::size_t j = 0; j < matrix.size_n; ++j) {
+        for (std::size_t i = 0; i < matrix.n_rows; ++i) {
+            for (std::size_t j = 0; j < matrix.n_cols; ++j) {
                  // Print as double as requested for simplicity
-                os << std::setw(max_width) << static_cast<double>(matrix.data[i][j]);
+                os << std::setw(max_width) << static_cast<double>(matrix.row(i)[j]);
             }
             os << std::endl;
         }
@@ -163,8 +1146,8 @@ public:
 
     // Friend function to overload operator>> for reading from stream
     friend std::istream& operator>>(std::istream& is, Matrix<T>& matrix) {
-         for (std::size_t i = 0; i < matrix.size_n; ++i) {
-            for (std::size_t j = 0; j < matrix.size_n; ++j) {
+         for (std::size_t i = 0; i < matrix.n_rows; ++i) {
+            for (std::size_t j = 0; j < matrix.n_cols; ++j) {
                 T value;
                 if (!(is >> value)) {
                     // Set failbit and potentially throw or let caller check stream state
@@ -173,7 +1156,7 @@ public:
                 }
                 // Use set_value to implicitly check bounds if needed, though direct access is fine here
                 // matrix.set_value(i, j, value);
-                 matrix.data[i][j] = value; // Direct access okay after constructor ensures size
+                 matrix.mutable_row(i)[j] = value; // Direct access okay after constructor ensures size
             }
         }
         return is;
@@ -0,0 +1,186 @@
+#include <iostream>
+#include <string>
+#include <vector>
+#include <chrono>
+#include <random>
+#include <thread>
+#include <stdexcept>
+#include <cmath>
+#include <limits>
+
+#include "matrix.hpp"
+
+// One measured configuration
+struct Candidate {
+    MatrixConfig config;
+    double seconds;
+};
+
+// Best-of-`repeats` wall time of a * b under the given configuration
+double time_multiply(const Matrix<double>& a, const Matrix<double>& b, const MatrixConfig& config,
+                     int repeats, const Matrix<double>& reference, bool& matches) {
+    matrix_config() = config;
+    double best = 0.0;
+    matches = true;
+    for (int r = 0; r < repeats; ++r) {
+        auto start = std::chrono::steady_clock::now();
+        Matrix<double> product = a * b;
+        std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+        if (r == 0 || elapsed.count() < best) {
+            best = elapsed.count();
+        }
+        if (r == 0) {
+            // Kernels differ only in rounding (e.g. FMA contraction). With entries
+            // in [-1, 1] each sum of N products is off by at most about N^2 eps.
+            const double N = static_cast<double>(a.get_size());
+            const double tolerance = 4.0 * N * N * std::numeric_limits<double>::epsilon();
+            for (std::size_t i = 0; i < a.get_size() && matches; ++i) {
+                for (std::size_t j = 0; j < a.get_size(); ++j) {
+                    if (std::abs(product.get_value(i, j) - reference.get_value(i, j)) > tolerance) {
+                        matches = false;
+                        break;
+                    }
+                }
+            }
+        }
+    }
+    return best;
+}
+
+void describe(const MatrixConfig& config) {
+    std::cout << (config.kernel == MatmulKernel::naive ? "naive" : "blocked");
+    if (config.kernel == MatmulKernel::blocked) {
+        std::cout << " block_size=" << config.block_size << " unroll=" << config.unroll;
+    }
+    std::cout << " threads=" << config.threads;
+}
+
+// Parse a positive count no larger than max; std::stoul alone accepts "-1" and wraps it
+std::size_t parse_count(const std::string& value, std::size_t max) {
+    if (value.empty() || value[0] == '-' || value[0] == '+') {
+        throw std::invalid_argument("not a positive count");
+    }
+    std::size_t pos = 0;
+    unsigned long count = std::stoul(value, &pos);
+    if (pos != value.size() || count == 0 || count > max) {
+        throw std::out_of_range("count out of range");
+    }
+    return count;
+}
+
+void print_usage(const char* program) {
+    std::cerr << "Usage: " << program << " [--size=N] [--max-threads=N] [--repeats=N] [--output=path]" << std::endl;
+}
+
+int main(int argc, char *argv[]) {
+    std::size_t N = 512;
+    unsigned max_threads = std::thread::hardware_concurrency();
+    int repeats = 2;
+    std::string output = default_profile_path();
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        try {
+            if (arg.rfind("--size=", 0) == 0) {
+                N = parse_count(arg.substr(7), 1 << 16); // 2^16 x 2^16 doubles is already 32 GiB
+            } else if (arg.rfind("--max-threads=", 0) == 0) {
+                max_threads = static_cast<unsigned>(parse_count(arg.substr(14), 4096));
+            } else if (arg.rfind("--repeats=", 0) == 0) {
+                repeats = static_cast<int>(parse_count(arg.substr(10), 1000));
+            } else if (arg.rfind("--output=", 0) == 0) {
+                output = arg.substr(9);
+            } else {
+                print_usage(argv[0]);
+                return 1;
+            }
+        } catch (const std::exception&) {
+            std::cerr << "Error: Invalid value in \"" << arg << "\"." << std::endl;
+            return 1;
+        }
+    }
+    if (max_threads == 0) {
+        max_threads = 1;
+    }
+
+    // Start from defaults, not from a profile left by a previous run
+    MatrixConfig base;
+    base.numa = matrix_config().numa;
+    base.pin_threads = matrix_config().pin_threads;
+
+    std::mt19937 rng(348);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    Matrix<double> a(N);
+    Matrix<double> b(N);
+    for (std::size_t i = 0; i < N; ++i) {
+        for (std::size_t j = 0; j < N; ++j) {
+            a.set_value(i, j, dist(rng));
+            b.set_value(i, j, dist(rng));
+        }
+    }
+
+    std::cout << "Tuning matrix multiplication for N = " << N << " (best of " << repeats << " runs)\n" << std::endl;
+
+    MatrixConfig naive = base;
+    naive.kernel = MatmulKernel::naive;
+    naive.threads = 1;
+    matrix_config() = naive;
+    Matrix<double> reference = a * b;
+
+    std::vector<MatrixConfig> kernels = { naive };
+    for (std::size_t block : { 16, 32, 64, 128, 256 }) {
+        for (std::size_t unroll : { 1, 2, 4, 8 }) {
+            MatrixConfig blocked = base;
+            blocked.kernel = MatmulKernel::blocked;
+            blocked.block_size = block;
+            blocked.unroll = unroll;
+            blocked.threads = 1;
+            kernels.push_back(blocked);
+        }
+    }
+
+    // Stage 1: single-threaded kernel, tile and unroll search
+    Candidate best{ naive, 0.0 };
+    bool have_best = false;
+    for (const MatrixConfig& config : kernels) {
+        bool matches;
+        double seconds = time_multiply(a, b, config, repeats, reference, matches);
+        describe(config);
+        std::cout << ": " << seconds * 1000.0 << " ms" << (matches ? "" : " (result mismatch, skipped)") << std::endl;
+        if (matches && (!have_best || seconds < best.seconds)) {
+            best = { config, seconds };
+            have_best = true;
+        }
+    }
+
+    // Stage 2: thread count for the winning kernel
+    std::vector<unsigned> thread_counts;
+    for (unsigned t = 2; t < max_threads; t *= 2) {
+        thread_counts.push_back(t);
+    }
+    if (max_threads > 1) {
+        thread_counts.push_back(max_threads);
+    }
+    MatrixConfig single = best.config;
+    for (unsigned threads : thread_counts) {
+        MatrixConfig config = single;
+        config.threads = threads;
+        bool matches;
+        double seconds = time_multiply(a, b, config, repeats, reference, matches);
+        describe(config);
+        std::cout << ": " << seconds * 1000.0 << " ms" << (matches ? "" : " (result mismatch, skipped)") << std::endl;
+        if (matches && seconds < best.seconds) {
+            best = { config, seconds };
+        }
+    }
+
+    std::cout << "\nBest: ";
+    describe(best.config);
+    std::cout << " (" << best.seconds * 1000.0 << " ms)" << std::endl;
+
+    if (!save_matrix_profile(output, best.config)) {
+        std::cerr << "Error: Cannot write profile \"" << output << "\"" << std::endl;
+        return 1;
+    }
+    std::cout << "Profile written to " << output << std::endl;
+    return 0;
+}
@@ -0,0 +1,264 @@
+#include <gtest/gtest.h>
+#include <vector>
+#include <string>
+#include <random>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <cmath>
+#include <sstream>
+
+#include "matrix.hpp"
+
+// Randomized differential tests: every optimized path of matrix.hpp is compared
+// against the plain triple loop below across odd, prime and power-of-two sizes.
+//
+//   MATRIX_DIFF_SEED=<n>   rerun with a fixed seed (printed with every failure)
+//   MATRIX_DIFF_MAX_N=<n>  largest N to test (default 512; up to 4096 for a long run)
+
+namespace {
+
+unsigned long env_or(const char* name, unsigned long fallback) {
+    const char* value = std::getenv(name);
+    if (value == nullptr || *value == '\0') {
+        return fallback;
+    }
+    return std::strtoul(value, nullptr, 10);
+}
+
+unsigned long base_seed() {
+    static const unsigned long seed = env_or("MATRIX_DIFF_SEED", std::random_device{}());
+    return seed;
+}
+
+std::vector<std::size_t> test_sizes() {
+    const std::size_t all[] = { 1, 2, 3, 4, 7, 8, 13, 16, 31, 64, 97, 128, 257, 509, 512, 1021, 1024,
+                                2048, 2053, 3001, 4096 };
+    std::size_t max_n = env_or("MATRIX_DIFF_MAX_N", 512);
+    std::vector<std::size_t> sizes;
+    for (std::size_t n : all) {
+        if (n <= max_n) {
+            sizes.push_back(n);
+        }
+    }
+    return sizes;
+}
+
+// Optimized configurations under test, described for failure messages
+struct NamedConfig {
+    std::string name;
+    MatrixConfig config;
+};
+
+std::vector<NamedConfig> test_configs() {
+    auto make = [](MatmulKernel kernel, std::size_t block, std::size_t unroll, unsigned threads, NumaPolicy numa) {
+        MatrixConfig config;
+        config.kernel = kernel;
+        config.block_size = block;
+        config.unroll = unroll;
+        config.threads = threads;
+        config.numa = numa;
+        config.pin_threads = threads > 1;
+        std::ostringstream name;
+        name << (kernel == MatmulKernel::naive ? "naive" : "blocked") << " block=" << block
+             << " unroll=" << unroll << " threads=" << threads << " numa=" << static_cast<int>(numa);
+        return NamedConfig{ name.str(), config };
+    };
+    return {
+        make(MatmulKernel::naive, 64, 1, 1, NumaPolicy::none),
+        make(MatmulKernel::blocked, 64, 4, 1, NumaPolicy::none),
+        make(MatmulKernel::blocked, 16, 1, 3, NumaPolicy::first_touch),
+        make(MatmulKernel::blocked, 37, 2, 4, NumaPolicy::interleave),
+        make(MatmulKernel::blocked, 128, 8, 2, NumaPolicy::first_touch),
+    };
+}
+
+// Distance between two doubles in units in the last place
+std::uint64_t ulp_distance(double a, double b) {
+    if (a == b) {
+        return 0;
+    }
+    if (std::isnan(a) || std::isnan(b)) {
+        return UINT64_MAX;
+    }
+    auto ordered = [](double x) {
+        std::int64_t bits;
+        std::memcpy(&bits, &x, sizeof(bits));
+        // Map the sign-magnitude encoding onto a monotonic integer line
+        return bits < 0 ? INT64_MIN - bits : bits;
+    };
+    std::int64_t ia = ordered(a);
+    std::int64_t ib = ordered(b);
+    return ia > ib ? static_cast<std::uint64_t>(ia) - static_cast<std::uint64_t>(ib)
+                   : static_cast<std::uint64_t>(ib) - static_cast<std::uint64_t>(ia);
+}
+
+// Integers stay small enough that N=4096 products cannot overflow; doubles are
+// positive so a reordered sum of K terms stays within K ULPs of the reference.
+template <typename T>
+std::vector<std::vector<T>> random_table(std::size_t rows, std::size_t cols, std::mt19937_64& rng) {
+    std::vector<std::vector<T>> table(rows, std::vector<T>(cols));
+    if constexpr (std::is_integral_v<T>) {
+        std::uniform_int_distribution<int> dist(-9, 9);
+        for (auto& row : table) {
+            for (auto& value : row) {
+                value = dist(rng);
+            }
+        }
+    } else {
+        std::uniform_real_distribution<double> dist(0.0, 1.0);
+        for (auto& row : table) {
+            for (auto& value : row) {
+                value = dist(rng);
+            }
+        }
+    }
+    return table;
+}
+
+template <typename T>
+Matrix<T> to_matrix(const std::vector<std::vector<T>>& table) {
+    Matrix<T> matrix(table.size(), table[0].size());
+    for (std::size_t i = 0; i < table.size(); ++i) {
+        for (std::size_t j = 0; j < table[i].size(); ++j) {
+            matrix.set_value(i, j, table[i][j]);
+        }
+    }
+    return matrix;
+}
+
+// Reference implementations: the obvious loops, independent of matrix.hpp kernels
+template <typename T>
+std::vector<std::vector<T>> reference_multiply(const std::vector<std::vector<T>>& a, const std::vector<std::vector<T>>& b) {
+    std::vector<std::vector<T>> c(a.size(), std::vector<T>(b[0].size()));
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        for (std::size_t j = 0; j < b[0].size(); ++j) {
+            T sum = 0;
+            for (std::size_t k = 0; k < b.size(); ++k) {
+                sum += a[i][k] * b[k][j];
+            }
+            c[i][j] = sum;
+        }
+    }
+    return c;
+}
+
+template <typename T>
+std::vector<std::vector<T>> reference_add(const std::vector<std::vector<T>>& a, const std::vector<std::vector<T>>& b) {
+    std::vector<std::vector<T>> c = a;
+    for (std::size_t i = 0; i < a.size(); ++i) {
+        for (std::size_t j = 0; j < a[i].size(); ++j) {
+            c[i][j] += b[i][j];
+        }
+    }
+    return c;
+}
+
+// Compare every element; integers must match exactly, doubles within max_ulps.
+// Reports only the first mismatch to keep large-N failures readable.
+template <typename T>
+void expect_matches(const Matrix<T>& actual, const std::vector<std::vector<T>>& expected, std::uint64_t max_ulps) {
+    ASSERT_EQ(actual.get_rows(), expected.size());
+    ASSERT_EQ(actual.get_cols(), expected[0].size());
+    for (std::size_t i = 0; i < expected.size(); ++i) {
+        for (std::size_t j = 0; j < expected[i].size(); ++j) {
+            T value = actual.get_value(i, j);
+            bool ok;
+            if constexpr (std::is_integral_v<T>) {
+                ok = value == expected[i][j];
+            } else {
+                ok = ulp_distance(value, expected[i][j]) <= max_ulps;
+            }
+            if (!ok) {
+                ADD_FAILURE() << "Mismatch at (" << i << ", " << j << "): got " << value
+                              << ", expected " << expected[i][j];
+                return;
+            }
+        }
+    }
+}
+
+template <typename T>
+class DifferentialTest : public ::testing::Test {
+protected:
+    MatrixConfig saved;
+    void SetUp() override { saved = matrix_config(); }
+    void TearDown() override { matrix_config() = saved; }
+
+    // Seed for one case, so a failure can be replayed in isolation
+    static unsigned long case_seed(std::size_t n) {
+        return base_seed() * 1000003UL + n;
+    }
+
+    static std::string trace(std::size_t n) {
+        std::ostringstream message;
+        message << "N=" << n << " case seed " << case_seed(n)
+                << " (reproduce with MATRIX_DIFF_SEED=" << base_seed() << ")";
+        return message.str();
+    }
+};
+
+using ValueTypes = ::testing::Types<int, double>;
+TYPED_TEST_SUITE(DifferentialTest, ValueTypes);
+
+TYPED_TEST(DifferentialTest, SquareMultiplyAndAdd) {
+    using T = TypeParam;
+    for (std::size_t n : test_sizes()) {
+        SCOPED_TRACE(this->trace(n));
+        std::mt19937_64 rng(this->case_seed(n));
+        auto a = random_table<T>(n, n, rng);
+        auto b = random_table<T>(n, n, rng);
+        auto expected_product = reference_multiply(a, b);
+        auto expected_sum = reference_add(a, b);
+        Matrix<T> ma = to_matrix(a);
+        Matrix<T> mb = to_matrix(b);
+        for (const NamedConfig& named : test_configs()) {
+            SCOPED_TRACE(named.name);
+            matrix_config() = named.config;
+            expect_matches(ma * mb, expected_product, n);
+            expect_matches(ma + mb, expected_sum, 0);
+            if (this->HasFailure()) {
+                return;
+            }
+        }
+    }
+}
+
+TYPED_TEST(DifferentialTest, RectangularAndVector) {
+    using T = TypeParam;
+    for (std::size_t n : test_sizes()) {
+        SCOPED_TRACE(this->trace(n));
+        std::mt19937_64 rng(this->case_seed(n));
+        std::size_t inner = n / 2 + 1;
+        std::size_t skinny = 3;
+        auto a = random_table<T>(n, inner, rng);      // Tall: n x inner
+        auto b = random_table<T>(inner, skinny, rng); // inner x 3
+        auto x = random_table<T>(inner, 1, rng);      // Column vector
+        auto expected_tall = reference_multiply(a, b);
+        auto expected_vector = reference_multiply(a, x);
+        Matrix<T> ma = to_matrix(a);
+        Matrix<T> mb = to_matrix(b);
+        Matrix<T> mx = to_matrix(x);
+        std::vector<T> xv(inner);
+        for (std::size_t k = 0; k < inner; ++k) {
+            xv[k] = x[k][0];
+        }
+        for (const NamedConfig& named : test_configs()) {
+            SCOPED_TRACE(named.name);
+            matrix_config() = named.config;
+            expect_matches(ma * mb, expected_tall, inner);
+            expect_matches(ma * mx, expected_vector, inner);
+            Matrix<T> y(n, 1);
+            std::vector<T> yv = ma * xv;
+            for (std::size_t i = 0; i < n; ++i) {
+                y.set_value(i, 0, yv[i]);
+            }
+            expect_matches(y, expected_vector, inner);
+            if (this->HasFailure()) {
+                return;
+            }
+        }
+    }
+}
+
+} // namespace
@@ -1,6 +1,12 @@
 #include <gtest/gtest.h>
 #include <vector>
 #include <stdexcept> // Include for std::out_of_range
+#include <fstream>
+#include <string>
+#include <random>
+#include <cmath>
+#include <limits>
+#include <thread>
 
 #include "matrix.hpp" // Include the header with the template class
 
@@ -450,3 +456,515 @@ TEST(MatrixImplementationOperations, MismatchedDimensions) {
     EXPECT_THROW(matrix3x3 + matrix2x2, std::invalid_argument);
     EXPECT_THROW(matrix3x3 * matrix2x2, std::invalid_argument);
 }
+
+// --- Tests for threaded execution and NUMA placement ---
+
+// Restores the shared configuration when a test finishes
+class MatrixConfigTest : public ::testing::Test {
+protected:
+    MatrixConfig saved;
+    void SetUp() override { saved = matrix_config(); }
+    void TearDown() override { matrix_config() = saved; }
+};
+
+TEST_F(MatrixConfigTest, ThreadedResultsMatchSerial) {
+    std::vector<std::vector<int>> values(7, std::vector<int>(7));
+    for (size_t i = 0; i < 7; ++i) {
+        for (size_t j = 0; j < 7; ++j) {
+            values[i][j] = static_cast<int>(i * 7 + j) - 20;
+        }
+    }
+    Matrix<int> matrix(values);
+    Matrix<int> expected_sum = matrix + matrix;
+    Matrix<int> expected_product = matrix * matrix;
+
+    const NumaPolicy policies[] = { NumaPolicy::none, NumaPolicy::first_touch, NumaPolicy::interleave };
+    for (NumaPolicy policy : policies) {
+        for (unsigned threads : { 2u, 3u, 16u }) {
+            matrix_config().numa = policy;
+            matrix_config().threads = threads;
+            matrix_config().pin_threads = true;
+            Matrix<int> sum = matrix + matrix;
+            Matrix<int> product = matrix * matrix;
+            for (size_t i = 0; i < 7; ++i) {
+                for (size_t j = 0; j < 7; ++j) {
+                    EXPECT_EQ(sum.get_value(i, j), expected_sum.get_value(i, j));
+                    EXPECT_EQ(product.get_value(i, j), expected_product.get_value(i, j));
+                }
+            }
+        }
+    }
+}
+
+TEST_F(MatrixConfigTest, FirstTouchAllocationIsZeroed) {
+    matrix_config().numa = NumaPolicy::first_touch;
+    matrix_config().threads = 4;
+    Matrix<double> matrix(9);
+    for (size_t i = 0; i < 9; ++i) {
+        for (size_t j = 0; j < 9; ++j) {
+            EXPECT_EQ(matrix.get_value(i, j), 0.0);
+        }
+    }
+}
+
+TEST_F(MatrixConfigTest, InitialDataHonorsNumaPolicy) {
+    const std::vector<std::vector<int>> values = { {1, 2, 3}, {4, 5, 6}, {7, 8, 9}, {10, 11, 12} };
+    for (NumaPolicy policy : { NumaPolicy::first_touch, NumaPolicy::interleave }) {
+        matrix_config().numa = policy;
+        matrix_config().threads = 3;
+        Matrix<int> matrix(values);
+        for (size_t i = 0; i < 4; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                EXPECT_EQ(matrix.get_value(i, j), values[i][j]);
+            }
+        }
+    }
+}
+
+#ifdef __linux__
+TEST_F(MatrixConfigTest, InterleaveRestoresPreviousPolicy) {
+    // Stand-in for a policy inherited from numactl: prefer node 0
+    const int MPOL_DEFAULT_MODE = 0;
+    const int MPOL_PREFERRED_MODE = 1;
+    unsigned long node0 = 1;
+    if (syscall(SYS_set_mempolicy, MPOL_PREFERRED_MODE, &node0, sizeof(node0) * 8 + 1) != 0) {
+        GTEST_SKIP() << "set_mempolicy is not available";
+    }
+    matrix_config().numa = NumaPolicy::interleave;
+    Matrix<double> matrix(16);
+    matrix.set_value(0, 0, 1.0);
+
+    int mode = -1;
+    std::vector<unsigned long> mask(1024 / (sizeof(unsigned long) * 8));
+    ASSERT_EQ(syscall(SYS_get_mempolicy, &mode, mask.data(), 1024UL, nullptr, 0UL), 0);
+    syscall(SYS_set_mempolicy, MPOL_DEFAULT_MODE, nullptr, 0UL);
+    EXPECT_EQ(mode, MPOL_PREFERRED_MODE);
+    EXPECT_EQ(mask[0] & 1UL, 1UL);
+}
+#endif
+
+TEST_F(MatrixConfigTest, WorkerPoolReusesThreadsAndPropagatesErrors) {
+    matrix_config().threads = 4;
+    matrix_config().pin_threads = true;
+    auto worker_ids = [] {
+        std::vector<std::thread::id> ids(4);
+        matrix_detail::parallel_rows(4, [&ids](std::size_t begin, std::size_t end) {
+            for (std::size_t i = begin; i < end; ++i) {
+                ids[i] = std::this_thread::get_id();
+            }
+        });
+        return ids;
+    };
+    std::vector<std::thread::id> first = worker_ids();
+    EXPECT_NE(first[0], std::this_thread::get_id());
+    EXPECT_EQ(worker_ids(), first); // Row block w is always served by the same thread
+
+    EXPECT_THROW(matrix_detail::parallel_rows(4, [](std::size_t begin, std::size_t) {
+        if (begin == 2) {
+            throw std::runtime_error("worker failed");
+        }
+    }), std::runtime_error);
+
+    // A smaller job after the failure still runs, on the same leading threads
+    matrix_config().threads = 2;
+    std::vector<std::thread::id> ids(2);
+    matrix_detail::parallel_rows(2, [&ids](std::size_t begin, std::size_t) {
+        ids[begin] = std::this_thread::get_id();
+    });
+    EXPECT_EQ(ids[0], first[0]);
+    EXPECT_EQ(ids[1], first[1]);
+}
+
+TEST(MatrixNuma, OnlineNodesNotEmpty) {
+    EXPECT_FALSE(online_numa_nodes().empty());
+}
+
+TEST_F(MatrixConfigTest, BlockedKernelMatchesNaive) {
+    const size_t N = 37; // Not a multiple of any block size or unroll factor
+    std::vector<std::vector<double>> values(N, std::vector<double>(N));
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            values[i][j] = static_cast<double>((i * 31 + j * 17) % 23) / 7.0 - 1.5;
+        }
+    }
+    Matrix<double> matrix(values);
+    matrix_config().kernel = MatmulKernel::naive;
+    Matrix<double> expected = matrix * matrix;
+    // Kernels may round differently (FMA contraction), so allow the standard
+    // summation error bound 2 * N * eps * sum(|a_ik| * |b_kj|)
+    std::vector<std::vector<double>> bound(N, std::vector<double>(N));
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            for (size_t k = 0; k < N; ++k) {
+                bound[i][j] += std::abs(values[i][k] * values[k][j]);
+            }
+            bound[i][j] *= 2.0 * N * std::numeric_limits<double>::epsilon();
+        }
+    }
+
+    matrix_config().kernel = MatmulKernel::blocked;
+    for (size_t block : { 1, 5, 16, 64 }) {
+        for (size_t unroll : { 1, 2, 4, 8 }) {
+            matrix_config().block_size = block;
+            matrix_config().unroll = unroll;
+            Matrix<double> result = matrix * matrix;
+            for (size_t i = 0; i < N; ++i) {
+                for (size_t j = 0; j < N; ++j) {
+                    EXPECT_NEAR(result.get_value(i, j), expected.get_value(i, j), bound[i][j]);
+                }
+            }
+        }
+    }
+}
+
+TEST(MatrixProfile, SaveAndLoadRoundTrip) {
+    MatrixConfig tuned;
+    tuned.kernel = MatmulKernel::naive;
+    tuned.block_size = 128;
+    tuned.unroll = 8;
+    tuned.threads = 3;
+    tuned.lu_panel_width = 16;
+    std::string path = ::testing::TempDir() + "matrix_tune_roundtrip.profile";
+    ASSERT_TRUE(save_matrix_profile(path, tuned));
+
+    MatrixConfig loaded;
+    ASSERT_TRUE(load_matrix_profile(path, loaded));
+    EXPECT_EQ(loaded.kernel, MatmulKernel::naive);
+    EXPECT_EQ(loaded.block_size, 128u);
+    EXPECT_EQ(loaded.unroll, 8u);
+    EXPECT_EQ(loaded.threads, 3u);
+    EXPECT_EQ(loaded.lu_panel_width, 16u);
+}
+
+TEST(MatrixProfile, MissingFileKeepsDefaults) {
+    MatrixConfig config;
+    EXPECT_FALSE(load_matrix_profile(::testing::TempDir() + "no_such_matrix.profile", config));
+    MatrixConfig defaults;
+    EXPECT_EQ(config.kernel, defaults.kernel);
+    EXPECT_EQ(config.block_size, defaults.block_size);
+    EXPECT_EQ(config.unroll, defaults.unroll);
+    EXPECT_EQ(config.threads, defaults.threads);
+}
+
+TEST(MatrixProfile, InvalidValuesAreIgnored) {
+    std::string path = ::testing::TempDir() + "matrix_tune_invalid.profile";
+    {
+        std::ofstream profile(path);
+        profile << "# comment\nblock_size=abc\nunroll=3\nthreads=0\nkernel=blocked\nunknown=1\n";
+    }
+    MatrixConfig config;
+    ASSERT_TRUE(load_matrix_profile(path, config));
+    MatrixConfig defaults;
+    EXPECT_EQ(config.block_size, defaults.block_size);
+    EXPECT_EQ(config.unroll, defaults.unroll);
+    EXPECT_EQ(config.threads, defaults.threads);
+    EXPECT_EQ(config.kernel, MatmulKernel::blocked);
+}
+
+// --- Tests for rectangular matrices and matrix-vector products ---
+
+TEST(MatrixImplementationRectangular, Dimensions) {
+    Matrix<int> matrix({ {1, 2, 3}, {4, 5, 6} });
+    EXPECT_EQ(matrix.get_rows(), 2);
+    EXPECT_EQ(matrix.get_cols(), 3);
+    EXPECT_FALSE(matrix.is_square());
+    EXPECT_EQ(matrix.get_value(1, 2), 6);
+    EXPECT_THROW(matrix.get_value(2, 0), std::out_of_range);
+    EXPECT_THROW(matrix.get_value(0, 3), std::out_of_range);
+
+    Matrix<double> zeros(4, 2);
+    EXPECT_EQ(zeros.get_rows(), 4);
+    EXPECT_EQ(zeros.get_cols(), 2);
+    EXPECT_THROW(Matrix<int>(0, 3), std::invalid_argument);
+    EXPECT_THROW(Matrix<int>(3, 0), std::invalid_argument);
+
+    // A brace literal for a column vector is a 2 x 1 matrix, not Matrix(1, 2)
+    Matrix<int> column({ {1}, {2} });
+    EXPECT_EQ(column.get_rows(), 2);
+    EXPECT_EQ(column.get_cols(), 1);
+    EXPECT_EQ(column.get_value(0, 0), 1);
+    EXPECT_EQ(column.get_value(1, 0), 2);
+}
+
+TEST(MatrixImplementationRectangular, Multiplication) {
+    Matrix<int> matrix1({ {1, 2, 3}, {4, 5, 6} }); // 2 x 3
+    Matrix<int> matrix2({ {7, 8}, {9, 10}, {11, 12} }); // 3 x 2
+    std::vector<std::vector<int>> expected = { {58, 64}, {139, 154} };
+    Matrix<int> result = matrix1 * matrix2;
+    ASSERT_EQ(result.get_rows(), 2);
+    ASSERT_EQ(result.get_cols(), 2);
+    for (size_t i = 0; i < expected.size(); ++i) {
+        for (size_t j = 0; j < expected[i].size(); ++j) {
+            EXPECT_EQ(result.get_value(i, j), expected[i][j]);
+        }
+    }
+
+    Matrix<int> outer = matrix2 * matrix1; // 3 x 3
+    EXPECT_EQ(outer.get_rows(), 3);
+    EXPECT_EQ(outer.get_cols(), 3);
+    EXPECT_EQ(outer.get_value(2, 2), 11 * 3 + 12 * 6);
+
+    EXPECT_THROW(matrix1 * matrix1, std::invalid_argument);
+    EXPECT_THROW(matrix1 + matrix2, std::invalid_argument);
+}
+
+TEST(MatrixImplementationRectangular, MatrixVector) {
+    Matrix<double> matrix({ {1.0, 2.0, 3.0, 4.0, 5.0}, {0.5, 0.0, -1.0, 2.0, 1.0} });
+    std::vector<double> x = { 1.0, 1.0, 2.0, 0.5, -1.0 };
+    std::vector<double> y = matrix * x;
+    ASSERT_EQ(y.size(), 2);
+    EXPECT_NEAR(y[0], 1.0 + 2.0 + 6.0 + 2.0 - 5.0, 1e-9);
+    EXPECT_NEAR(y[1], 0.5 + 0.0 - 2.0 + 1.0 - 1.0, 1e-9);
+
+    // A single-column right-hand side takes the same path
+    Matrix<double> column({ {1.0}, {1.0}, {2.0}, {0.5}, {-1.0} });
+    Matrix<double> product = matrix * column;
+    ASSERT_EQ(product.get_cols(), 1);
+    EXPECT_NEAR(product.get_value(0, 0), y[0], 1e-9);
+    EXPECT_NEAR(product.get_value(1, 0), y[1], 1e-9);
+
+    EXPECT_THROW(matrix * std::vector<double>(4), std::invalid_argument);
+}
+
+TEST(MatrixImplementationRectangular, SquareOnlyOperations) {
+    Matrix<int> matrix({ {1, 2, 3}, {4, 5, 6} });
+    EXPECT_THROW(matrix.sum_diagonal_major(), std::invalid_argument);
+    EXPECT_THROW(matrix.sum_diagonal_minor(), std::invalid_argument);
+    matrix.swap_rows(0, 1);
+    matrix.swap_cols(0, 2);
+    EXPECT_EQ(matrix.get_value(0, 0), 6);
+    EXPECT_EQ(matrix.get_value(1, 2), 1);
+    EXPECT_THROW(matrix.swap_rows(0, 2), std::out_of_range);
+    EXPECT_NO_THROW(matrix.swap_cols(0, 2));
+}
+
+// --- Tests for LU decomposition, determinant, solve and inverse ---
+
+TEST(MatrixImplementationLU, DeterminantInt) {
+    Matrix<int> matrix({
+        { 2, -3, 1 },
+        { 2,  0, -1 },
+        { 1,  4, 5 },
+    });
+    EXPECT_NEAR(matrix.determinant(), 49.0, 1e-9);
+
+    Matrix<int> needs_pivot({ {0, 1}, {1, 0} });
+    EXPECT_NEAR(needs_pivot.determinant(), -1.0, 1e-12);
+}
+
+TEST(MatrixImplementationLU, SingularMatrix) {
+    Matrix<double> matrix({
+        { 1.0, 2.0, 3.0 },
+        { 4.0, 5.0, 6.0 },
+        { 2.0, 4.0, 6.0 },
+    });
+    EXPECT_NEAR(matrix.determinant(), 0.0, 1e-12);
+    EXPECT_TRUE(matrix.lu().singular);
+    EXPECT_THROW(matrix.inverse(), std::runtime_error);
+    EXPECT_THROW(matrix.solve(std::vector<double>{ 1.0, 2.0, 3.0 }), std::runtime_error);
+}
+
+TEST(MatrixImplementationLU, ExactlySingularDeterminantIsPlainZero) {
+    // Pivoting gives sign -1 and a zero pivot; sign * 0 would print as -0.00
+    Matrix<int> matrix({ {1, 2}, {2, 4} });
+    double det = matrix.determinant();
+    EXPECT_EQ(det, 0.0);
+    EXPECT_FALSE(std::signbit(det));
+}
+
+TEST(MatrixImplementationLU, ReuseFactors) {
+    Matrix<double> matrix({
+        { 4.0, -2.0, 1.0 },
+        { -2.0, 4.0, -2.0 },
+        { 1.0, -2.0, 4.0 },
+    });
+    LUDecomposition<double> factors = matrix.lu();
+    EXPECT_EQ(matrix.determinant(factors), matrix.determinant());
+    std::vector<double> b{ 11.0, -16.0, 17.0 };
+    EXPECT_EQ(matrix.solve(factors, b), matrix.solve(b));
+    Matrix<double> inverse = matrix.inverse(factors);
+    Matrix<double> expected = matrix.inverse();
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_EQ(inverse.get_value(i, j), expected.get_value(i, j));
+        }
+    }
+    Matrix<double> other(4);
+    EXPECT_THROW(other.determinant(factors), std::invalid_argument);
+}
+
+TEST(MatrixImplementationLU, SolveAndInverse) {
+    Matrix<double> matrix({
+        { 4.0, -2.0, 1.0 },
+        { -2.0, 4.0, -2.0 },
+        { 1.0, -2.0, 4.0 },
+    });
+    std::vector<double> x = matrix.solve(std::vector<double>{ 11.0, -16.0, 17.0 });
+    ASSERT_EQ(x.size(), 3);
+    EXPECT_NEAR(x[0], 1.0, 1e-12);
+    EXPECT_NEAR(x[1], -2.0, 1e-12);
+    EXPECT_NEAR(x[2], 3.0, 1e-12);
+
+    Matrix<double> identity = matrix * matrix.inverse();
+    for (size_t i = 0; i < 3; ++i) {
+        for (size_t j = 0; j < 3; ++j) {
+            EXPECT_NEAR(identity.get_value(i, j), i == j ? 1.0 : 0.0, 1e-12);
+        }
+    }
+}
+
+TEST(MatrixImplementationLU, BadlyScaledIsNotSingular) {
+    // Well conditioned despite entries twenty orders of magnitude apart
+    Matrix<double> matrix({ {1e10, 0.0}, {0.0, 1e-10} });
+    EXPECT_FALSE(matrix.lu().singular);
+    EXPECT_NEAR(matrix.determinant(), 1.0, 1e-12);
+    std::vector<double> x = matrix.solve(std::vector<double>{ 1e10, 1e-10 });
+    ASSERT_EQ(x.size(), 2);
+    EXPECT_NEAR(x[0], 1.0, 1e-12);
+    EXPECT_NEAR(x[1], 1.0, 1e-12);
+    Matrix<double> inverse = matrix.inverse();
+    EXPECT_NEAR(inverse.get_value(0, 0), 1e-10, 1e-22);
+    EXPECT_NEAR(inverse.get_value(1, 1), 1e10, 1e-2);
+}
+
+TEST(MatrixImplementationLU, RequiresSquare) {
+    Matrix<double> matrix({ {1.0, 2.0, 3.0}, {4.0, 5.0, 6.0} });
+    EXPECT_THROW(matrix.determinant(), std::invalid_argument);
+    EXPECT_THROW(matrix.inverse(), std::invalid_argument);
+    Matrix<double> square(2);
+    EXPECT_THROW(square.solve(std::vector<double>(3)), std::invalid_argument);
+}
+
+TEST_F(MatrixConfigTest, BlockedThreadedLU) {
+    // Several panels and a ragged last block exercise the trailing GEMM update
+    matrix_config().lu_panel_width = 8;
+    matrix_config().block_size = 16;
+    matrix_config().threads = 3;
+    const size_t N = 45;
+    Matrix<double> matrix(N);
+    Matrix<double> rhs(N, 2);
+    std::mt19937 rng(348);
+    std::uniform_real_distribution<double> dist(-1.0, 1.0);
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            matrix.set_value(i, j, dist(rng));
+        }
+        rhs.set_value(i, 0, static_cast<double>(i % 5));
+        rhs.set_value(i, 1, 1.0);
+    }
+
+    LUDecomposition<double> factors = matrix.lu();
+    ASSERT_FALSE(factors.singular);
+    // Rebuild P * A from the packed factors and compare
+    Matrix<double> lower(N);
+    Matrix<double> upper(N);
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            if (j < i) {
+                lower.set_value(i, j, factors.lu.get_value(i, j));
+            } else {
+                upper.set_value(i, j, factors.lu.get_value(i, j));
+            }
+        }
+        lower.set_value(i, i, 1.0);
+    }
+    Matrix<double> rebuilt = lower * upper;
+    for (size_t i = 0; i < N; ++i) {
+        for (size_t j = 0; j < N; ++j) {
+            EXPECT_NEAR(rebuilt.get_value(i, j), matrix.get_value(factors.pivots[i], j), 1e-9);
+        }
+    }
+
+    Matrix<double> x = matrix.solve(rhs);
+    Matrix<double> residual = matrix * x;
+    for (size_t i = 0; i < N; ++i) {
+        EXPECT_NEAR(residual.get_value(i, 0), rhs.get_value(i, 0), 1e-8);
+        EXPECT_NEAR(residual.get_value(i, 1), rhs.get_value(i, 1), 1e-8);
+    }
+    // A panel wider than the matrix degenerates to one unblocked factorization
+    matrix_config().lu_panel_width = 4096;
+    double det = factors.sign;
+    for (size_t i = 0; i < N; ++i) {
+        det *= factors.lu.get_value(i, i);
+    }
+    EXPECT_NEAR(matrix.determinant(), det, 1e-9 * std::abs(det));
+}
+
+// --- Tests for copy-on-write storage ---
+
+TEST(MatrixImplementationCopyOnWrite, CopySharesStorage) {
+    Matrix<int> matrix({ {1, 2, 3}, {4, 5, 6}, {7, 8, 9} });
+    Matrix<int> copy = matrix;
+    EXPECT_EQ(matrix.storage_bytes(), 9 * sizeof(int));
+    EXPECT_EQ(Matrix<int>::storage_bytes({ &matrix, &copy }), 9 * sizeof(int));
+
+    Matrix<int> deep = matrix.deep_copy();
+    EXPECT_EQ(Matrix<int>::storage_bytes({ &matrix, &deep }), 18 * sizeof(int));
+}
+
+TEST(MatrixImplementationCopyOnWrite, SetValueClonesOneRow) {
+    Matrix<int> matrix({ {1, 2, 3}, {4, 5, 6}, {7, 8, 9} });
+    Matrix<int> copy = matrix;
+    copy.set_value(1, 1, 50);
+    EXPECT_EQ(copy.get_value(1, 1), 50);
+    EXPECT_EQ(matrix.get_value(1, 1), 5);
+    EXPECT_EQ(Matrix<int>::storage_bytes({ &matrix, &copy }), 12 * sizeof(int));
+
+    // The original now owns its row alone and is written in place
+    matrix.set_value(1, 0, 40);
+    EXPECT_EQ(matrix.get_value(1, 0), 40);
+    EXPECT_EQ(copy.get_value(1, 0), 4);
+    EXPECT_EQ(Matrix<int>::storage_bytes({ &matrix, &copy }), 12 * sizeof(int));
+}
+
+TEST(MatrixImplementationCopyOnWrite, SwapRowsCopiesNoRows) {
+    Matrix<int> matrix({ {1, 2, 3}, {4, 5, 6}, {7, 8, 9} });
+    Matrix<int> copy = matrix;
+    copy.swap_rows(0, 2);
+    EXPECT_EQ(copy.get_value(0, 0), 7);
+    EXPECT_EQ(matrix.get_value(0, 0), 1);
+    EXPECT_EQ(Matrix<int>::storage_bytes({ &matrix, &copy }), 9 * sizeof(int));
+}
+
+TEST(MatrixImplementationCopyOnWrite, SwapColsAndChainedCopies) {
+    Matrix<double> matrix({ {1.0, 2.0}, {3.0, 4.0} });
+    Matrix<double> first = matrix;
+    Matrix<double> second = first;
+    second.swap_cols(0, 1);
+    first.set_value(0, 0, 9.0);
+    EXPECT_EQ(matrix.get_value(0, 0), 1.0);
+    EXPECT_EQ(matrix.get_value(1, 1), 4.0);
+    EXPECT_EQ(first.get_value(0, 0), 9.0);
+    EXPECT_EQ(first.get_value(1, 0), 3.0);
+    EXPECT_EQ(second.get_value(0, 0), 2.0);
+    EXPECT_EQ(second.get_value(1, 0), 4.0);
+
+    // Results of arithmetic never alias their operands
+    Matrix<double> sum = matrix + matrix;
+    sum.set_value(0, 1, -1.0);
+    EXPECT_EQ(matrix.get_value(0, 1), 2.0);
+}
+
+TEST_F(MatrixConfigTest, CopyOnWriteUnderNumaPolicies) {
+    const NumaPolicy policies[] = { NumaPolicy::first_touch, NumaPolicy::interleave };
+    for (NumaPolicy policy : policies) {
+        matrix_config().numa = policy;
+        matrix_config().threads = 3;
+        Matrix<int> matrix({ {1, 2, 3}, {4, 5, 6}, {7, 8, 9}, {10, 11, 12} });
+        Matrix<int> swapped = matrix;
+        swapped.swap_cols(0, 2);
+        Matrix<int> updated = matrix;
+        updated.set_value(3, 1, 0);
+        Matrix<int> deep = matrix.deep_copy();
+        for (size_t i = 0; i < 4; ++i) {
+            for (size_t j = 0; j < 3; ++j) {
+                int original = static_cast<int>(i * 3 + j + 1);
+                EXPECT_EQ(matrix.get_value(i, j), original);
+                EXPECT_EQ(deep.get_value(i, j), original);
+                EXPECT_EQ(swapped.get_value(i, 2 - j), original);
+                EXPECT_EQ(updated.get_value(i, j), (i == 3 && j == 1) ? 0 : original);
+            }
+        }
+        EXPECT_EQ(Matrix<int>::storage_bytes({ &matrix, &swapped, &updated }), 27 * sizeof(int));
+    }
+}